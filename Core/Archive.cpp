@@ -24,130 +24,307 @@
 // ----------------------------------------------------------------------------
 #include "Archive.h"
 
+struct ArchiveEntry {
+  std::string name;
+  uint size;
+  unz_file_pos position;
+};
+
+typedef ArchiveEntry archiveEntry;
+
+struct ArchiveDirectory {
+  std::string filename;
+  long size;
+  time_t modified;
+  uint used;
+  std::vector<archiveEntry> entries;
+};
+
+typedef ArchiveDirectory archiveDirectory;
+
+struct Archive {
+  unzFile file;
+  std::vector<archiveEntry> entries;
+};
+
+static archiveDirectory archive_cache[ARCHIVE_CACHE_SIZE];
+static uint archive_clock = 0;
+
 // ----------------------------------------------------------------------------
-// GetUncompressedFileSize
+// Lookup
 // ----------------------------------------------------------------------------
-uint archive_GetUncompressedFileSize(std::string filename) {
-  if((filename.empty( ) || filename.size( ) == 0)) {
-    logger_LogError(IDS_ZIP1,"");
-    return 0;
+static archiveDirectory* archive_Lookup(std::string filename, long size, time_t modified) {
+  for(uint index = 0; index < ARCHIVE_CACHE_SIZE; index++) {
+    archiveDirectory* directory = &archive_cache[index];
+    if(directory->used != 0 && directory->size == size && directory->modified == modified && directory->filename == filename) {
+      directory->used = ++archive_clock;
+      return directory;
+    }
   }
-  
-  unzFile file = unzOpen(filename.c_str( ));
-  if(file == NULL) {
-    logger_LogInfo(IDS_ZIP2,filename);
-    return 0;
+  return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Insert
+// ----------------------------------------------------------------------------
+static void archive_Insert(std::string filename, long size, time_t modified, const std::vector<archiveEntry>& entries) {
+  archiveDirectory* directory = &archive_cache[0];
+  for(uint index = 1; index < ARCHIVE_CACHE_SIZE; index++) {
+    if(archive_cache[index].used < directory->used) {
+      directory = &archive_cache[index];
+    }
   }
+  directory->filename = filename;
+  directory->size = size;
+  directory->modified = modified;
+  directory->used = ++archive_clock;
+  directory->entries = entries;
+}
 
-  int result = unzGoToFirstFile(file);
-  if(result != UNZ_OK) {
-    logger_LogInfo(IDS_ZIP3, "");
-    unzClose(file);
-    return 0;
+// ----------------------------------------------------------------------------
+// ReadDirectory
+// ----------------------------------------------------------------------------
+static bool archive_ReadDirectory(archive* handle, std::string filename) {
+  struct stat info = {0};
+  bool cacheable = (stat(filename.c_str( ), &info) == 0);
+  if(cacheable) {
+    const archiveDirectory* directory = archive_Lookup(filename, info.st_size, info.st_mtime);
+    if(directory != NULL) {
+      handle->entries = directory->entries;
+      return true;
+    }
   }
-  
-  unz_file_info_s zipInfo = {0};
-  char buffer[_MAX_PATH] = {0};
-  result = unzGetCurrentFileInfo(file, &zipInfo, buffer, _MAX_PATH, NULL, 0, NULL, 0);
-  if(result != UNZ_OK) {
-    logger_LogInfo(IDS_ZIP5, "");
-    unzClose(file);
-    return 0;
+
+  int result = unzGoToFirstFile(handle->file);
+  while(result == UNZ_OK) {
+    unz_file_info_s zipInfo = {0};
+    char buffer[_MAX_PATH] = {0};
+    archiveEntry entry;
+    if(unzGetCurrentFileInfo(handle->file, &zipInfo, buffer, _MAX_PATH, NULL, 0, NULL, 0) != UNZ_OK || unzGetFilePos(handle->file, &entry.position) != UNZ_OK) {
+      return false;
+    }
+    entry.name = buffer;
+    entry.size = zipInfo.uncompressed_size;
+    handle->entries.push_back(entry);
+    result = unzGoToNextFile(handle->file);
   }
-  
-  uint size = zipInfo.uncompressed_size;
-  unzClose(file);
-  return size;
+  if(result != UNZ_END_OF_LIST_OF_FILE || handle->entries.empty( )) {
+    return false;
+  }
+
+  if(cacheable) {
+    archive_Insert(filename, info.st_size, info.st_mtime, handle->entries);
+  }
+  return true;
 }
 
 // ----------------------------------------------------------------------------
-// Uncompress
+// Open
 // ----------------------------------------------------------------------------
-bool archive_Uncompress(std::string filename, byte* data, uint size) {
+archive* archive_Open(std::string filename) {
   if(filename.empty( ) || filename.size( ) == 0) {
     logger_LogError(IDS_ZIP1,"");
-    return false;
-  }
-  if(data == NULL) {
-    logger_LogError(IDS_ZIP6,"");
-    return false;  
+    return NULL;
   }
 
   unzFile file = unzOpen(filename.c_str( ));
   if(file == NULL) {
     logger_LogInfo(IDS_ZIP2,filename);
-    return false;
+    return NULL;
   }
 
-  int result = unzGoToFirstFile(file);
-  if(result != UNZ_OK) {
-    logger_LogInfo(IDS_ZIP3 ,filename);
-    unzClose(file);
-    return false;
+  archive* handle = new archive;
+  handle->file = file;
+  if(!archive_ReadDirectory(handle, filename)) {
+    logger_LogInfo(IDS_ZIP3,filename);
+    archive_Close(handle);
+    return NULL;
   }
+  return handle;
+}
 
-  result = unzOpenCurrentFile(file);
-  if(result != UNZ_OK) {
-    logger_LogInfo(IDS_ZIP3 ,filename);
-    unzClose(file);
-    return false;  
-  }
+// ----------------------------------------------------------------------------
+// GetCount
+// ----------------------------------------------------------------------------
+uint archive_GetCount(const archive* handle) {
+  return (handle != NULL)? handle->entries.size( ): 0;
+}
+
+// ----------------------------------------------------------------------------
+// GetName
+// ----------------------------------------------------------------------------
+std::string archive_GetName(const archive* handle, uint index) {
+  return (index < archive_GetCount(handle))? handle->entries[index].name: "";
+}
+
+// ----------------------------------------------------------------------------
+// GetSize
+// ----------------------------------------------------------------------------
+uint archive_GetSize(const archive* handle, uint index) {
+  return (index < archive_GetCount(handle))? handle->entries[index].size: 0;
+}
 
-  result = unzReadCurrentFile(file, data, size);
-  if(result != size) {
-    logger_LogInfo(IDS_ZIP8 ,filename);
-    unzCloseCurrentFile(file);
-    unzClose(file);
+// ----------------------------------------------------------------------------
+// HasExtension
+// ----------------------------------------------------------------------------
+static bool archive_HasExtension(const std::string& name, const std::string& extension) {
+  if(extension.empty( ) || extension.size( ) > name.size( )) {
     return false;
   }
-
-  unzCloseCurrentFile(file);
-  unzClose(file);
+  uint offset = name.size( ) - extension.size( );
+  for(uint index = 0; index < extension.size( ); index++) {
+    if(tolower(name[offset + index]) != tolower(extension[index])) {
+      return false;
+    }
+  }
   return true;
 }
 
 // ----------------------------------------------------------------------------
-// Compress
+// Find
 // ----------------------------------------------------------------------------
-bool archive_Compress(std::string zipFilename, std::string filename, const byte* data, uint size) {
-  if(zipFilename.empty( ) || zipFilename.size( ) == 0) {
-    logger_LogError(IDS_ZIP1,"");
-    return false;
-  }  
-  if(filename.empty( ) || filename.size( ) == 0) {
-    logger_LogError(IDS_ZIP9,"");
-    return false;
+uint archive_Find(const archive* handle, std::string extensions) {
+  for(uint index = 0; index < archive_GetCount(handle); index++) {
+    std::string::size_type start = 0;
+    while(start < extensions.size( )) {
+      std::string::size_type end = extensions.find(';', start);
+      if(end == std::string::npos) {
+        end = extensions.size( );
+      }
+      if(archive_HasExtension(handle->entries[index].name, extensions.substr(start, end - start))) {
+        return index;
+      }
+      start = end + 1;
+    }
   }
-  if(data == NULL) {
+  return ARCHIVE_NONE;
+}
+
+// ----------------------------------------------------------------------------
+// Inflate
+// ----------------------------------------------------------------------------
+static uint archive_Inflate(archive* handle, uint index, byte* data, uint size, hashContext* context, archiveRange range) {
+  if(data == NULL || index >= archive_GetCount(handle)) {
     logger_LogError(IDS_ZIP6,"");
-    return false;  
+    return 0;
   }
-  
+
+  archiveEntry& entry = handle->entries[index];
+  if(unzGoToFilePos(handle->file, &entry.position) != UNZ_OK || unzOpenCurrentFile(handle->file) != UNZ_OK) {
+    logger_LogInfo(IDS_ZIP3,entry.name);
+    return 0;
+  }
+
+  if(size > entry.size) {
+    size = entry.size;
+  }
+  uint start = 0;
+  uint end = size;
+  uint offset = 0;
+  while(offset < size) {
+    uint length = (context != NULL && size - offset > ARCHIVE_CHUNK_SIZE)? ARCHIVE_CHUNK_SIZE: size - offset;
+    int result = unzReadCurrentFile(handle->file, data + offset, length);
+    if(result != (int)length) {
+      break;
+    }
+    if(context != NULL) {
+      if(offset == 0 && range != NULL) {
+        uint hashed = size;
+        range(data, size, start, hashed);
+        start = (start < size)? start: size;
+        end = (hashed < size - start)? start + hashed: size;
+      }
+      uint first = (offset > start)? offset: start;
+      uint last = (offset + length < end)? offset + length: end;
+      if(first < last) {
+        hash_Update(*context, data + first, last - first);
+      }
+    }
+    offset += length;
+  }
+  unzCloseCurrentFile(handle->file);
+  if(offset != size) {
+    logger_LogInfo(IDS_ZIP8,entry.name);
+    return 0;
+  }
+  return size;
+}
+
+// ----------------------------------------------------------------------------
+// Read
+// ----------------------------------------------------------------------------
+uint archive_Read(archive* handle, uint index, byte* data, uint size) {
+  return archive_Inflate(handle, index, data, size, NULL, NULL);
+}
+
+// ----------------------------------------------------------------------------
+// Read
+// ----------------------------------------------------------------------------
+uint archive_Read(archive* handle, uint index, byte* data, uint size, hashContext& context, archiveRange range) {
+  return archive_Inflate(handle, index, data, size, &context, range);
+}
+
+// ----------------------------------------------------------------------------
+// Close
+// ----------------------------------------------------------------------------
+void archive_Close(archive* handle) {
+  if(handle != NULL) {
+    unzClose(handle->file);
+    delete handle;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Deflate
+// ----------------------------------------------------------------------------
+int archive_Deflate(std::string zipFilename, std::string filename, const byte* data, uint size, int level) {
   zipFile file = zipOpen(zipFilename.c_str( ), APPEND_STATUS_CREATE);
   if(file == NULL) {
-    logger_LogInfo(IDS_ZIP10, zipFilename);
-    return false;
+    return IDS_ZIP10;
   }
   
   zip_fileinfo fileInfo = {0};
   fileInfo.dosDate = 1;
   
-  int result = zipOpenNewFileInZip(file, filename.c_str( ), &fileInfo, NULL, 0, NULL, 0, NULL, Z_DEFLATED, Z_BEST_COMPRESSION);
+  int result = zipOpenNewFileInZip(file, filename.c_str( ), &fileInfo, NULL, 0, NULL, 0, NULL, Z_DEFLATED, level);
   if(result != ZIP_OK) {
-    logger_LogInfo(IDS_ZIP11, filename);
     zipClose(file, "Failed to compress.");
-    return false;  
+    return IDS_ZIP11;
   }
   
   result = zipWriteInFileInZip(file, data, size);
   if(result != ZIP_OK) {
-    logger_LogInfo(IDS_ZIP12, filename);
     zipCloseFileInZip(file);
     zipClose(file, "Failed to compress.");
-    return false;
+    return IDS_ZIP12;
   }
  
   zipCloseFileInZip(file);
   zipClose(file, "Comment");
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Compress
+// ----------------------------------------------------------------------------
+bool archive_Compress(std::string zipFilename, std::string filename, const byte* data, uint size, int level) {
+  if(zipFilename.empty( ) || zipFilename.size( ) == 0) {
+    logger_LogError(IDS_ZIP1,"");
+    return false;
+  }  
+  if(filename.empty( ) || filename.size( ) == 0) {
+    logger_LogError(IDS_ZIP9,"");
+    return false;
+  }
+  if(data == NULL) {
+    logger_LogError(IDS_ZIP6,"");
+    return false;  
+  }
+  
+  int result = archive_Deflate(zipFilename, filename, data, size, level);
+  if(result != 0) {
+    logger_LogInfo(result, (result == IDS_ZIP10)? zipFilename: filename);
+    return false;
+  }
   return true;
 }
\ No newline at end of file
@@ -24,10 +24,20 @@
 // ----------------------------------------------------------------------------
 #ifndef ARCHIVE_H
 #define ARCHIVE_H
+#define ARCHIVE_CACHE_SIZE 8
+#define ARCHIVE_NONE 0xffffffff
+#define ARCHIVE_CHUNK_SIZE 16384
+#define NULL 0
 
 #include <String>
+#include <Vector>
+#include <Ctype.h>
+#include <Stdlib.h>
+#include <Sys/Types.h>
+#include <Sys/Stat.h>
 #include "Logger.h"
 #include "Cartridge.h"
+#include "Hash.h"
 #include "Zip.h"
 #include "Unzip.h"
 
@@ -35,8 +45,19 @@ typedef unsigned char byte;
 typedef unsigned short word;
 typedef unsigned int uint;
 
-extern uint archive_GetUncompressedFileSize(std::string filename);
-extern bool archive_Uncompress(std::string filename, byte* data, uint size);
-extern bool archive_Compress(std::string zipFilename, std::string filename, const byte* data, uint size);
+struct Archive;
+typedef Archive archive;
+typedef void (*archiveRange)(const byte* data, uint size, uint& offset, uint& length);
+
+extern archive* archive_Open(std::string filename);
+extern uint archive_GetCount(const archive* handle);
+extern std::string archive_GetName(const archive* handle, uint index);
+extern uint archive_GetSize(const archive* handle, uint index);
+extern uint archive_Find(const archive* handle, std::string extensions);
+extern uint archive_Read(archive* handle, uint index, byte* data, uint size);
+extern uint archive_Read(archive* handle, uint index, byte* data, uint size, hashContext& context, archiveRange range);
+extern void archive_Close(archive* handle);
+extern int archive_Deflate(std::string zipFilename, std::string filename, const byte* data, uint size, int level);
+extern bool archive_Compress(std::string zipFilename, std::string filename, const byte* data, uint size, int level);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,241 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Audio.cpp
+// ----------------------------------------------------------------------------
+#include "Audio.h"
+#define AUDIO_BUFFER_MASK (AUDIO_BUFFER_SIZE - 1)
+#define AUDIO_CHUNK_SIZE 1024
+
+uint audio_latency = 2048;
+uint audio_underruns = 0;
+uint audio_overruns = 0;
+uint audio_fillMin = 0;
+uint audio_fillMax = 0;
+
+static short audio_buffer[AUDIO_BUFFER_SIZE] = {0};
+static volatile uint audio_head = 0;
+static volatile uint audio_tail = 0;
+static short audio_last = 0;
+static uint audio_sampleRate = 44100;
+static FILE* audio_file = NULL;
+static uint audio_fileSize = 0;
+
+// ----------------------------------------------------------------------------
+// Pop
+// ----------------------------------------------------------------------------
+static uint audio_Pop(short* samples, uint length) {
+  uint tail = audio_tail;
+  uint fill = audio_head - tail;
+  thread_Barrier( );
+
+  if(fill < audio_fillMin) {
+    audio_fillMin = fill;
+  }
+  if(fill > audio_fillMax) {
+    audio_fillMax = fill;
+  }
+
+  uint count = (fill < length)? fill: length;
+  for(uint index = 0; index < count; index++) {
+    samples[index] = audio_buffer[(tail + index) & AUDIO_BUFFER_MASK];
+  }
+  thread_Barrier( );
+  audio_tail = tail + count;
+  return count;
+}
+
+// ----------------------------------------------------------------------------
+// WriteUint
+// ----------------------------------------------------------------------------
+static void audio_WriteUint(byte* buffer, uint value, uint size) {
+  for(uint index = 0; index < size; index++) {
+    buffer[index] = (value >> (index << 3)) & 255;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteHeader
+// ----------------------------------------------------------------------------
+static bool audio_WriteHeader( ) {
+  byte header[44] = {'R','I','F','F',0,0,0,0,'W','A','V','E','f','m','t',' ',16,0,0,0,1,0,1,0,0,0,0,0,0,0,0,0,2,0,16,0,'d','a','t','a',0,0,0,0};
+  audio_WriteUint(header + 4, 36 + audio_fileSize, 4);
+  audio_WriteUint(header + 24, audio_sampleRate, 4);
+  audio_WriteUint(header + 28, audio_sampleRate << 1, 4);
+  audio_WriteUint(header + 40, audio_fileSize, 4);
+  return fseek(audio_file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), audio_file) == sizeof(header);
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void audio_Reset( ) {
+  audio_head = 0;
+  audio_tail = 0;
+  audio_last = 0;
+  audio_underruns = 0;
+  audio_overruns = 0;
+  audio_fillMin = AUDIO_BUFFER_SIZE;
+  audio_fillMax = 0;
+  mixer_Reset( );
+}
+
+// ----------------------------------------------------------------------------
+// SetSampleRate
+// ----------------------------------------------------------------------------
+void audio_SetSampleRate(uint rate) {
+  mixer_SetSampleRate(rate);
+  audio_sampleRate = mixer_GetSampleRate( );
+}
+
+// ----------------------------------------------------------------------------
+// SetLatency
+// ----------------------------------------------------------------------------
+void audio_SetLatency(uint latency) {
+  if(latency == 0) {
+    latency = 1;
+  }
+  else if(latency > AUDIO_BUFFER_SIZE / 2) {
+    latency = AUDIO_BUFFER_SIZE / 2;
+  }
+  audio_latency = latency;
+}
+
+// ----------------------------------------------------------------------------
+// Store
+// ----------------------------------------------------------------------------
+uint audio_Store( ) {
+  int range = audio_sampleRate / AUDIO_RATE_ADJUST;
+  int adjust = ((int)audio_latency - (int)audio_GetFill( )) * range / (int)audio_latency;
+  if(adjust > range) {
+    adjust = range;
+  }
+  else if(adjust < -range) {
+    adjust = -range;
+  }
+  mixer_SetSampleRate(audio_sampleRate + adjust);
+
+  short samples[MIXER_BUFFER_SIZE];
+  uint length = mixer_Mix(samples, MIXER_BUFFER_SIZE);
+  return audio_Write(samples, length);
+}
+
+// ----------------------------------------------------------------------------
+// Write
+// ----------------------------------------------------------------------------
+uint audio_Write(const short* samples, uint length) {
+  uint head = audio_head;
+  uint space = AUDIO_BUFFER_SIZE - (head - audio_tail);
+  if(length > space) {
+    audio_overruns++;
+    length = space;
+  }
+  for(uint index = 0; index < length; index++) {
+    audio_buffer[(head + index) & AUDIO_BUFFER_MASK] = samples[index];
+  }
+  thread_Barrier( );
+  audio_head = head + length;
+  return length;
+}
+
+// ----------------------------------------------------------------------------
+// Read
+// ----------------------------------------------------------------------------
+uint audio_Read(short* samples, uint length) {
+  uint count = audio_Pop(samples, length);
+  if(count != 0) {
+    audio_last = samples[count - 1];
+  }
+  if(count < length) {
+    audio_underruns++;
+    for(uint index = count; index < length; index++) {
+      samples[index] = audio_last;
+    }
+  }
+  return count;
+}
+
+// ----------------------------------------------------------------------------
+// GetFill
+// ----------------------------------------------------------------------------
+uint audio_GetFill( ) {
+  return audio_head - audio_tail;
+}
+
+// ----------------------------------------------------------------------------
+// Drain
+// ----------------------------------------------------------------------------
+uint audio_Drain( ) {
+  short samples[AUDIO_CHUNK_SIZE];
+  byte data[AUDIO_CHUNK_SIZE << 1];
+  uint total = 0;
+  uint count;
+  while((count = audio_Pop(samples, AUDIO_CHUNK_SIZE)) != 0) {
+    if(audio_file != NULL) {
+      for(uint index = 0; index < count; index++) {
+        audio_WriteUint(data + (index << 1), (word)samples[index], 2);
+      }
+      if(fwrite(data, 1, count << 1, audio_file) != count << 1) {
+        logger_LogError(IDS_AUDIO2,"");
+        audio_CloseFile( );
+      }
+      else {
+        audio_fileSize += count << 1;
+      }
+    }
+    total += count;
+  }
+  return total;
+}
+
+// ----------------------------------------------------------------------------
+// OpenFile
+// ----------------------------------------------------------------------------
+bool audio_OpenFile(std::string filename) {
+  audio_CloseFile( );
+  audio_file = fopen(filename.c_str( ), "wb");
+  if(audio_file == NULL) {
+    logger_LogError(IDS_AUDIO1,filename);
+    return false;
+  }
+  audio_fileSize = 0;
+  if(!audio_WriteHeader( )) {
+    logger_LogError(IDS_AUDIO2,filename);
+    fclose(audio_file);
+    audio_file = NULL;
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// CloseFile
+// ----------------------------------------------------------------------------
+void audio_CloseFile( ) {
+  if(audio_file != NULL) {
+    if(!audio_WriteHeader( )) {
+      logger_LogError(IDS_AUDIO2,"");
+    }
+    fclose(audio_file);
+    audio_file = NULL;
+  }
+}
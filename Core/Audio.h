@@ -0,0 +1,57 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Audio.h
+// ----------------------------------------------------------------------------
+#ifndef AUDIO_H
+#define AUDIO_H
+#define AUDIO_BUFFER_SIZE 16384
+#define AUDIO_RATE_ADJUST 200
+#define NULL 0
+
+#include <Stdio.h>
+#include <String>
+#include "Logger.h"
+#include "Mixer.h"
+#include "Thread.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern void audio_Reset( );
+extern void audio_SetSampleRate(uint rate);
+extern void audio_SetLatency(uint latency);
+extern uint audio_Store( );
+extern uint audio_Write(const short* samples, uint length);
+extern uint audio_Read(short* samples, uint length);
+extern uint audio_GetFill( );
+extern uint audio_Drain( );
+extern bool audio_OpenFile(std::string filename);
+extern void audio_CloseFile( );
+extern uint audio_latency;
+extern uint audio_underruns;
+extern uint audio_overruns;
+extern uint audio_fillMin;
+extern uint audio_fillMax;
+
+#endif
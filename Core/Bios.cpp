@@ -23,9 +23,12 @@
 // Bios.cpp
 // ----------------------------------------------------------------------------
 #include "Bios.h"
+#define BIOS_EXTENSIONS ".rom;.bin"
 
 bool bios_enabled = false;
 std::string bios_filename;
+std::string bios_digest;
+bool bios_handoff = false;
 
 static byte* bios_data = NULL;
 static word bios_size = 0;
@@ -42,8 +45,10 @@ bool bios_Load(std::string filename) {
   bios_Release( );
   logger_LogInfo(IDS_BIOS2, filename);
 
-  bios_size = archive_GetUncompressedFileSize(filename);
-  if(bios_size == 0) {
+  hashContext context;
+  hash_Initialize(context, HASH_MD5);
+  archive* handle = archive_Open(filename);
+  if(handle == NULL) {
     FILE* file = fopen(filename.c_str( ), "rb");
     if(file == NULL) {
       logger_LogError(IDS_BIOS3, filename);
@@ -72,13 +77,24 @@ bool bios_Load(std::string filename) {
     }
   
     fclose(file);
+    hash_Update(context, bios_data, bios_size);
   }
   else {
+    uint index = archive_Find(handle, BIOS_EXTENSIONS);
+    if(index == ARCHIVE_NONE) {
+      index = 0;
+    }
+    bios_size = archive_GetSize(handle, index);
     bios_data = new byte[bios_size];
-    archive_Uncompress(filename, bios_data, bios_size);
+    bios_size = archive_Read(handle, index, bios_data, bios_size, context, NULL);
+    archive_Close(handle);
   }
 
+  hashDigest digest;
+  hash_Finalize(context, digest);
   bios_filename = filename;
+  bios_digest = digest.md5;
+  memory_SetImage(MEMORY_IMAGE_BIOS, bios_data, bios_size);
   return true; 
 }
 
@@ -97,7 +113,9 @@ void bios_Release( ) {
     delete [ ] bios_data;
     bios_size = 0;
     bios_data = NULL;
+    memory_SetImage(MEMORY_IMAGE_BIOS, NULL, 0);
   }
+  bios_digest = "";
 }
 
 // ----------------------------------------------------------------------------
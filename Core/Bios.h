@@ -30,6 +30,7 @@
 #include "Memory.h"
 #include "Archive.h"
 #include "Logger.h"
+#include "Hash.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -40,6 +41,8 @@ extern bool bios_IsLoaded( );
 extern void bios_Store( );
 extern void bios_Release( );
 extern std::string bios_filename;
+extern std::string bios_digest;
 extern bool bios_enabled;
+extern bool bios_handoff;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,358 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Blitter.cpp
+// ----------------------------------------------------------------------------
+#include "Blitter.h"
+#define BLITTER_LEVEL_UNKNOWN 0xff
+#if defined(_MSC_VER) && _MSC_VER >= 1600 && (defined(_M_IX86) || defined(_M_X64))
+#define BLITTER_SSE2
+#if _MSC_VER >= 1700
+#define BLITTER_AVX2
+#endif
+#define BLITTER_TARGET_SSE2
+#define BLITTER_TARGET_AVX2
+#include <Intrin.h>
+#include <Immintrin.h>
+#elif (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) && (defined(__i386__) || defined(__x86_64__))
+#define BLITTER_SSE2
+#define BLITTER_AVX2
+#define BLITTER_TARGET_SSE2 __attribute__((target("sse2")))
+#define BLITTER_TARGET_AVX2 __attribute__((target("avx2")))
+#include <Immintrin.h>
+#include <Cpuid.h>
+#endif
+
+typedef void (*blitterRow)(byte* target, const byte* source, uint length);
+
+static uint blitter_pairs16[65536] = {0};
+static uint blitter_palette32[256] = {0};
+static byte blitter_supported = BLITTER_LEVEL_UNKNOWN;
+static byte blitter_level = BLITTER_LEVEL_UNKNOWN;
+static blitterRow blitter_row16 = NULL;
+static blitterRow blitter_row24 = NULL;
+static blitterRow blitter_row32 = NULL;
+
+// ----------------------------------------------------------------------------
+// Row16
+// ----------------------------------------------------------------------------
+static void blitter_Row16(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 2 <= length; indexX += 2) {
+    uint pair = blitter_pairs16[source[indexX] | (source[indexX + 1] << 8)];
+    memcpy(target + (indexX << 1), &pair, 4);
+  }
+  if(indexX < length) {
+    word pixel = (word)blitter_pairs16[source[indexX]];
+    memcpy(target + (indexX << 1), &pixel, 2);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Row24
+// ----------------------------------------------------------------------------
+static void blitter_Row24(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 4 <= length; indexX += 4) {
+    uint first = blitter_palette32[source[indexX + 0]];
+    uint second = blitter_palette32[source[indexX + 1]];
+    uint third = blitter_palette32[source[indexX + 2]];
+    uint fourth = blitter_palette32[source[indexX + 3]];
+    uint packed[3];
+    packed[0] = first | (second << 24);
+    packed[1] = (second >> 8) | (third << 16);
+    packed[2] = (third >> 16) | (fourth << 8);
+    memcpy(target + (indexX * 3), packed, 12);
+  }
+  for(; indexX < length; indexX++) {
+    uint color = blitter_palette32[source[indexX]];
+    target[(indexX * 3) + 0] = (byte)color;
+    target[(indexX * 3) + 1] = (byte)(color >> 8);
+    target[(indexX * 3) + 2] = (byte)(color >> 16);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Row32
+// ----------------------------------------------------------------------------
+static void blitter_Row32(byte* target, const byte* source, uint length) {
+  for(uint indexX = 0; indexX < length; indexX++) {
+    memcpy(target + (indexX << 2), blitter_palette32 + source[indexX], 4);
+  }
+}
+
+#if defined(BLITTER_SSE2)
+// ----------------------------------------------------------------------------
+// Row16Sse2
+// ----------------------------------------------------------------------------
+BLITTER_TARGET_SSE2 static void blitter_Row16Sse2(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 8 <= length; indexX += 8) {
+    const byte* indices = source + indexX;
+    __m128i pairs = _mm_setr_epi32(blitter_pairs16[indices[0] | (indices[1] << 8)], blitter_pairs16[indices[2] | (indices[3] << 8)], blitter_pairs16[indices[4] | (indices[5] << 8)], blitter_pairs16[indices[6] | (indices[7] << 8)]);
+    _mm_storeu_si128((__m128i*)(target + (indexX << 1)), pairs);
+  }
+  blitter_Row16(target + (indexX << 1), source + indexX, length - indexX);
+}
+
+// ----------------------------------------------------------------------------
+// Row24Sse2
+// ----------------------------------------------------------------------------
+BLITTER_TARGET_SSE2 static void blitter_Row24Sse2(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 6 <= length; indexX += 4) {
+    const byte* indices = source + indexX;
+    __m128i even = _mm_setr_epi32(blitter_palette32[indices[0]], 0, blitter_palette32[indices[2]], 0);
+    __m128i odd = _mm_setr_epi32(blitter_palette32[indices[1]], 0, blitter_palette32[indices[3]], 0);
+    __m128i pairs = _mm_or_si128(even, _mm_slli_epi64(odd, 24));
+    __m128i packed = _mm_or_si128(_mm_move_epi64(pairs), _mm_slli_si128(_mm_srli_si128(pairs, 8), 6));
+    _mm_storeu_si128((__m128i*)(target + (indexX * 3)), packed);
+  }
+  blitter_Row24(target + (indexX * 3), source + indexX, length - indexX);
+}
+
+// ----------------------------------------------------------------------------
+// Row32Sse2
+// ----------------------------------------------------------------------------
+BLITTER_TARGET_SSE2 static void blitter_Row32Sse2(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 4 <= length; indexX += 4) {
+    const byte* indices = source + indexX;
+    __m128i pixels = _mm_setr_epi32(blitter_palette32[indices[0]], blitter_palette32[indices[1]], blitter_palette32[indices[2]], blitter_palette32[indices[3]]);
+    _mm_storeu_si128((__m128i*)(target + (indexX << 2)), pixels);
+  }
+  blitter_Row32(target + (indexX << 2), source + indexX, length - indexX);
+}
+#endif
+
+#if defined(BLITTER_AVX2)
+// ----------------------------------------------------------------------------
+// Row16Avx2
+// ----------------------------------------------------------------------------
+BLITTER_TARGET_AVX2 static void blitter_Row16Avx2(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 16 <= length; indexX += 16) {
+    __m256i pairs = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(source + indexX)));
+    _mm256_storeu_si256((__m256i*)(target + (indexX << 1)), _mm256_i32gather_epi32((const int*)blitter_pairs16, pairs, 4));
+  }
+  blitter_Row16(target + (indexX << 1), source + indexX, length - indexX);
+}
+
+// ----------------------------------------------------------------------------
+// Row24Avx2
+// ----------------------------------------------------------------------------
+BLITTER_TARGET_AVX2 static void blitter_Row24Avx2(byte* target, const byte* source, uint length) {
+  const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  uint indexX = 0;
+  for(; indexX + 12 <= length; indexX += 8) {
+    __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(source + indexX)));
+    __m256i pixels = _mm256_shuffle_epi8(_mm256_i32gather_epi32((const int*)blitter_palette32, indices, 4), pack);
+    _mm_storeu_si128((__m128i*)(target + (indexX * 3)), _mm256_castsi256_si128(pixels));
+    _mm_storeu_si128((__m128i*)(target + (indexX * 3) + 12), _mm256_extracti128_si256(pixels, 1));
+  }
+  blitter_Row24(target + (indexX * 3), source + indexX, length - indexX);
+}
+
+// ----------------------------------------------------------------------------
+// Row32Avx2
+// ----------------------------------------------------------------------------
+BLITTER_TARGET_AVX2 static void blitter_Row32Avx2(byte* target, const byte* source, uint length) {
+  uint indexX = 0;
+  for(; indexX + 8 <= length; indexX += 8) {
+    __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(source + indexX)));
+    _mm256_storeu_si256((__m256i*)(target + (indexX << 2)), _mm256_i32gather_epi32((const int*)blitter_palette32, indices, 4));
+  }
+  blitter_Row32(target + (indexX << 2), source + indexX, length - indexX);
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Cpuid
+// ----------------------------------------------------------------------------
+#if defined(BLITTER_SSE2)
+static void blitter_Cpuid(uint leaf, uint* registers) {
+#if defined(_MSC_VER)
+  int values[4];
+  __cpuidex(values, leaf, 0);
+  for(uint index = 0; index < 4; index++) {
+    registers[index] = values[index];
+  }
+#else
+  registers[0] = registers[1] = registers[2] = registers[3] = 0;
+  if(leaf <= __get_cpuid_max(0, NULL)) {
+    __cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+  }
+#endif
+}
+#endif
+
+#if defined(BLITTER_AVX2)
+// ----------------------------------------------------------------------------
+// GetEnabledState
+// ----------------------------------------------------------------------------
+static uint blitter_GetEnabledState( ) {
+#if defined(_MSC_VER)
+  return (uint)_xgetbv(0);
+#else
+  uint low;
+  uint high;
+  __asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return low;
+#endif
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// GetSupportedLevel
+// ----------------------------------------------------------------------------
+byte blitter_GetSupportedLevel( ) {
+  if(blitter_supported != BLITTER_LEVEL_UNKNOWN) {
+    return blitter_supported;
+  }
+  blitter_supported = BLITTER_LEVEL_SCALAR;
+#if defined(BLITTER_SSE2)
+  uint registers[4];
+  blitter_Cpuid(0, registers);
+  uint leaves = registers[0];
+  blitter_Cpuid(1, registers);
+  if(registers[3] & (1 << 26)) {
+    blitter_supported = BLITTER_LEVEL_SSE2;
+  }
+#if defined(BLITTER_AVX2)
+  bool avx = (registers[2] & (1 << 27)) && (registers[2] & (1 << 28));
+  if(blitter_supported == BLITTER_LEVEL_SSE2 && avx && leaves >= 7 && (blitter_GetEnabledState( ) & 6) == 6) {
+    blitter_Cpuid(7, registers);
+    if(registers[1] & (1 << 5)) {
+      blitter_supported = BLITTER_LEVEL_AVX2;
+    }
+  }
+#endif
+#endif
+  return blitter_supported;
+}
+
+// ----------------------------------------------------------------------------
+// SetLevel
+// ----------------------------------------------------------------------------
+byte blitter_SetLevel(byte level) {
+  if(level > blitter_GetSupportedLevel( )) {
+    level = blitter_GetSupportedLevel( );
+  }
+  blitter_row16 = blitter_Row16;
+  blitter_row24 = blitter_Row24;
+  blitter_row32 = blitter_Row32;
+#if defined(BLITTER_SSE2)
+  if(level == BLITTER_LEVEL_SSE2) {
+    blitter_row16 = blitter_Row16Sse2;
+    blitter_row24 = blitter_Row24Sse2;
+    blitter_row32 = blitter_Row32Sse2;
+  }
+#endif
+#if defined(BLITTER_AVX2)
+  if(level == BLITTER_LEVEL_AVX2) {
+    blitter_row16 = blitter_Row16Avx2;
+    blitter_row24 = blitter_Row24Avx2;
+    blitter_row32 = blitter_Row32Avx2;
+  }
+#endif
+  blitter_level = level;
+  return level;
+}
+
+// ----------------------------------------------------------------------------
+// GetLevel
+// ----------------------------------------------------------------------------
+byte blitter_GetLevel( ) {
+  if(blitter_level == BLITTER_LEVEL_UNKNOWN) {
+    blitter_SetLevel(blitter_GetSupportedLevel( ));
+  }
+  return blitter_level;
+}
+
+// ----------------------------------------------------------------------------
+// SetPalette16
+// ----------------------------------------------------------------------------
+void blitter_SetPalette16(const word* palette) {
+  for(uint high = 0; high < 256; high++) {
+    uint* pairs = blitter_pairs16 + (high << 8);
+    uint pixel = palette[high] << 16;
+    for(uint low = 0; low < 256; low++) {
+      pairs[low] = pixel | palette[low];
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// SetPalette32
+// ----------------------------------------------------------------------------
+void blitter_SetPalette32(const uint* palette) {
+  for(uint index = 0; index < 256; index++) {
+    blitter_palette32[index] = palette[index] & 0xffffff;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Blit
+// ----------------------------------------------------------------------------
+static void blitter_Blit(blitterRow row, byte* target, uint pitch, const byte* source, uint length, uint height) {
+  for(uint indexY = 0; indexY < height; indexY++) {
+    row(target, source, length);
+    target += pitch;
+    source += length;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Blit8
+// ----------------------------------------------------------------------------
+void blitter_Blit8(byte* target, uint pitch, const byte* source, uint length, uint height) {
+  for(uint indexY = 0; indexY < height; indexY++) {
+    memcpy(target, source, length);
+    target += pitch;
+    source += length;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Blit16
+// ----------------------------------------------------------------------------
+void blitter_Blit16(byte* target, uint pitch, const byte* source, uint length, uint height) {
+  blitter_GetLevel( );
+  blitter_Blit(blitter_row16, target, pitch, source, length, height);
+}
+
+// ----------------------------------------------------------------------------
+// Blit24
+// ----------------------------------------------------------------------------
+void blitter_Blit24(byte* target, uint pitch, const byte* source, uint length, uint height) {
+  blitter_GetLevel( );
+  blitter_Blit(blitter_row24, target, pitch, source, length, height);
+}
+
+// ----------------------------------------------------------------------------
+// Blit32
+// ----------------------------------------------------------------------------
+void blitter_Blit32(byte* target, uint pitch, const byte* source, uint length, uint height) {
+  blitter_GetLevel( );
+  blitter_Blit(blitter_row32, target, pitch, source, length, height);
+}
@@ -0,0 +1,49 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Blitter.h
+// ----------------------------------------------------------------------------
+#ifndef BLITTER_H
+#define BLITTER_H
+#define NULL 0
+#define BLITTER_LEVEL_SCALAR 0
+#define BLITTER_LEVEL_SSE2 1
+#define BLITTER_LEVEL_AVX2 2
+
+#include <String.h>
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern byte blitter_GetSupportedLevel( );
+extern byte blitter_SetLevel(byte level);
+extern byte blitter_GetLevel( );
+extern void blitter_SetPalette16(const word* palette);
+extern void blitter_SetPalette32(const uint* palette);
+extern void blitter_Blit8(byte* target, uint pitch, const byte* source, uint length, uint height);
+extern void blitter_Blit16(byte* target, uint pitch, const byte* source, uint length, uint height);
+extern void blitter_Blit24(byte* target, uint pitch, const byte* source, uint length, uint height);
+extern void blitter_Blit32(byte* target, uint pitch, const byte* source, uint length, uint height);
+
+#endif
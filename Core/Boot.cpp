@@ -0,0 +1,92 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Boot.cpp
+// ----------------------------------------------------------------------------
+#include "Boot.h"
+
+std::string boot_path;
+bool boot_enabled = true;
+
+static bool boot_pending = false;
+static byte boot_state[PRO_SYSTEM_STATE_SIZE];
+
+// ----------------------------------------------------------------------------
+// GetFilename
+// ----------------------------------------------------------------------------
+static std::string boot_GetFilename( ) {
+  char machine[32];
+  sprintf(machine, "-%s-%02x-%08x", (region_GetActual( ) == REGION_PAL)? "pal": "ntsc", cartridge_type, cartridge_flags);
+  return boot_path + bios_digest + "-" + cartridge_digest + machine + ".boot";
+}
+
+// ----------------------------------------------------------------------------
+// Restore
+// ----------------------------------------------------------------------------
+bool boot_Restore( ) {
+  boot_pending = false;
+  bios_handoff = false;
+  if(!boot_enabled || !bios_enabled || !bios_IsLoaded( ) || !cartridge_IsLoaded( )) {
+    return false;
+  }
+
+  FILE* file = fopen(boot_GetFilename( ).c_str( ), "rb");
+  if(file == NULL) {
+    boot_pending = true;
+    return false;
+  }
+  uint size = fread(boot_state, 1, PRO_SYSTEM_STATE_SIZE, file);
+  fclose(file);
+
+  if(!prosystem_LoadState(boot_state, size)) {
+    boot_pending = true;
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Store
+// ----------------------------------------------------------------------------
+bool boot_Store( ) {
+  if(!boot_pending || !bios_handoff) {
+    return false;
+  }
+  boot_pending = false;
+  bios_handoff = false;
+
+  std::string filename = boot_GetFilename( );
+  uint size = prosystem_SaveState(boot_state, PRO_SYSTEM_STATE_SIZE);
+  FILE* file = fopen(filename.c_str( ), "wb");
+  if(file == NULL) {
+    logger_LogError(IDS_BOOT1,filename);
+    return false;
+  }
+  if(fwrite(boot_state, 1, size, file) != size) {
+    fclose(file);
+    remove(filename.c_str( ));
+    logger_LogError(IDS_BOOT1,filename);
+    return false;
+  }
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,341 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Capture.cpp
+// ----------------------------------------------------------------------------
+#include "Capture.h"
+#define CAPTURE_WAVE_HEADER_SIZE 44
+
+struct CaptureFrame {
+  byte* pixels;
+  byte palette[PALETTE_SIZE];
+  short* samples;
+  uint length;
+};
+
+typedef CaptureFrame captureFrame;
+
+bool capture_active = false;
+uint capture_frames = 0;
+uint capture_dropped = 0;
+
+static captureFrame* capture_queue = NULL;
+static volatile uint capture_head = 0;
+static volatile uint capture_tail = 0;
+static volatile bool capture_stopping = false;
+static volatile int capture_error = 0;
+static thread* capture_thread = NULL;
+static threadEvent* capture_event = NULL;
+static FILE* capture_video = NULL;
+static FILE* capture_audio = NULL;
+static byte* capture_pixels = NULL;
+static short* capture_samples = NULL;
+static byte* capture_planes = NULL;
+static byte* capture_data = NULL;
+static byte capture_yuv[256][3];
+static uint capture_width = 0;
+static uint capture_height = 0;
+static uint capture_frequency = 0;
+static uint capture_sampleRate = 0;
+static uint capture_length = 0;
+static uint capture_audioSize = 0;
+static std::string capture_videoFilename;
+static std::string capture_audioFilename;
+static std::string capture_errorFilename;
+
+// ----------------------------------------------------------------------------
+// WriteWaveHeader
+// ----------------------------------------------------------------------------
+static bool capture_WriteWaveHeader( ) {
+  byte header[CAPTURE_WAVE_HEADER_SIZE];
+  uint offset = 0;
+  state_WriteBytes(header, offset, (const byte*)"RIFF", 4);
+  state_WriteUint(header, offset, 36 + capture_audioSize);
+  state_WriteBytes(header, offset, (const byte*)"WAVEfmt ", 8);
+  state_WriteUint(header, offset, 16);
+  state_WriteWord(header, offset, 1);
+  state_WriteWord(header, offset, 1);
+  state_WriteUint(header, offset, capture_sampleRate);
+  state_WriteUint(header, offset, capture_sampleRate << 1);
+  state_WriteWord(header, offset, 2);
+  state_WriteWord(header, offset, 16);
+  state_WriteBytes(header, offset, (const byte*)"data", 4);
+  state_WriteUint(header, offset, capture_audioSize);
+  return fseek(capture_audio, 0, SEEK_SET) == 0 && fwrite(header, 1, offset, capture_audio) == offset;
+}
+
+// ----------------------------------------------------------------------------
+// WriteVideoHeader
+// ----------------------------------------------------------------------------
+static bool capture_WriteVideoHeader( ) {
+  return fprintf(capture_video, "YUV4MPEG2 W%u H%u F%u:1 Ip C444\n", capture_width, capture_height, capture_frequency) > 0;
+}
+
+// ----------------------------------------------------------------------------
+// ConvertPalette
+// ----------------------------------------------------------------------------
+static void capture_ConvertPalette(const byte* palette) {
+  for(uint index = 0; index < 256; index++) {
+    int r = palette[(index * 3) + 0];
+    int g = palette[(index * 3) + 1];
+    int b = palette[(index * 3) + 2];
+    capture_yuv[index][0] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+    capture_yuv[index][1] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+    capture_yuv[index][2] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteFrame
+// ----------------------------------------------------------------------------
+static int capture_WriteFrame(const captureFrame& frame) {
+  uint area = capture_width * capture_height;
+  capture_ConvertPalette(frame.palette);
+  byte* y = capture_planes;
+  byte* u = capture_planes + area;
+  byte* v = capture_planes + (area << 1);
+  uint index;
+  for(index = 0; index < area; index++) {
+    const byte* color = capture_yuv[frame.pixels[index]];
+    y[index] = color[0];
+    u[index] = color[1];
+    v[index] = color[2];
+  }
+  if(fputs("FRAME\n", capture_video) < 0 || fwrite(capture_planes, 1, area * 3, capture_video) != area * 3) {
+    capture_errorFilename = capture_videoFilename;
+    return IDS_CAPTURE2;
+  }
+
+  uint offset = 0;
+  for(index = 0; index < frame.length; index++) {
+    state_WriteWord(capture_data, offset, (word)frame.samples[index]);
+  }
+  if(fwrite(capture_data, 1, offset, capture_audio) != offset) {
+    capture_errorFilename = capture_audioFilename;
+    return IDS_CAPTURE2;
+  }
+  capture_audioSize += offset;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+static void capture_Run( ) {
+  while(capture_error == 0) {
+    bool stopping = capture_stopping;
+    thread_Barrier( );
+    uint tail = capture_tail;
+    if(tail == capture_head) {
+      if(stopping) {
+        break;
+      }
+      thread_Wait(capture_event);
+      continue;
+    }
+    int error = capture_WriteFrame(capture_queue[tail % CAPTURE_QUEUE_SIZE]);
+    thread_Barrier( );
+    capture_tail = tail + 1;
+    capture_error = error;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Free
+// ----------------------------------------------------------------------------
+static void capture_Free( ) {
+  if(capture_video != NULL) {
+    fclose(capture_video);
+    capture_video = NULL;
+  }
+  if(capture_audio != NULL) {
+    fclose(capture_audio);
+    capture_audio = NULL;
+  }
+  delete [ ] capture_queue;
+  capture_queue = NULL;
+  delete [ ] capture_pixels;
+  capture_pixels = NULL;
+  delete [ ] capture_samples;
+  capture_samples = NULL;
+  delete [ ] capture_planes;
+  capture_planes = NULL;
+  delete [ ] capture_data;
+  capture_data = NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Open
+// ----------------------------------------------------------------------------
+bool capture_Open(std::string videoFilename, std::string audioFilename, uint width, uint height, uint frequency, uint sampleRate, bool background) {
+  capture_Close( );
+  if(width == 0 || height == 0 || frequency == 0 || sampleRate < frequency) {
+    logger_LogError(IDS_CAPTURE1,videoFilename);
+    return false;
+  }
+
+  capture_video = fopen(videoFilename.c_str( ), "wb");
+  if(capture_video == NULL) {
+    logger_LogError(IDS_CAPTURE1,videoFilename);
+    return false;
+  }
+  capture_audio = fopen(audioFilename.c_str( ), "wb");
+  if(capture_audio == NULL) {
+    logger_LogError(IDS_CAPTURE1,audioFilename);
+    capture_Free( );
+    return false;
+  }
+
+  capture_width = width;
+  capture_height = height;
+  capture_frequency = frequency;
+  capture_sampleRate = sampleRate;
+  capture_length = sampleRate / frequency;
+  capture_audioSize = 0;
+  uint area = width * height;
+  capture_queue = new captureFrame[CAPTURE_QUEUE_SIZE];
+  capture_pixels = new byte[area * CAPTURE_QUEUE_SIZE];
+  capture_samples = new short[capture_length * CAPTURE_QUEUE_SIZE];
+  capture_planes = new byte[area * 3];
+  capture_data = new byte[capture_length << 1];
+  if(capture_queue == NULL || capture_pixels == NULL || capture_samples == NULL || capture_planes == NULL || capture_data == NULL) {
+    logger_LogError(IDS_CAPTURE2,videoFilename);
+    capture_Free( );
+    return false;
+  }
+  if(!capture_WriteVideoHeader( ) || !capture_WriteWaveHeader( )) {
+    logger_LogError(IDS_CAPTURE2,videoFilename);
+    capture_Free( );
+    return false;
+  }
+
+  for(uint index = 0; index < CAPTURE_QUEUE_SIZE; index++) {
+    capture_queue[index].pixels = capture_pixels + (index * area);
+    capture_queue[index].samples = capture_samples + (index * capture_length);
+  }
+  capture_videoFilename = videoFilename;
+  capture_audioFilename = audioFilename;
+  capture_head = 0;
+  capture_tail = 0;
+  capture_stopping = false;
+  capture_error = 0;
+  capture_frames = 0;
+  capture_dropped = 0;
+  capture_active = true;
+
+  capture_event = (background)? thread_CreateEvent( ): NULL;
+  if(capture_event != NULL) {
+    capture_thread = thread_Create(capture_Run);
+    if(capture_thread == NULL) {
+      thread_ReleaseEvent(capture_event);
+      capture_event = NULL;
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Store
+// ----------------------------------------------------------------------------
+bool capture_Store(const byte* pixels, const byte* palette, const short* samples, uint length) {
+  if(!capture_active || capture_error != 0) {
+    return false;
+  }
+  uint head = capture_head;
+  if(head - capture_tail >= CAPTURE_QUEUE_SIZE) {
+    capture_dropped++;
+    return false;
+  }
+
+  captureFrame& frame = capture_queue[head % CAPTURE_QUEUE_SIZE];
+  uint area = capture_width * capture_height;
+  if(length > capture_length) {
+    length = capture_length;
+  }
+  uint index;
+  for(index = 0; index < area; index++) {
+    frame.pixels[index] = pixels[index];
+  }
+  for(index = 0; index < PALETTE_SIZE; index++) {
+    frame.palette[index] = palette[index];
+  }
+  for(index = 0; index < length; index++) {
+    frame.samples[index] = samples[index];
+  }
+  frame.length = length;
+  capture_frames++;
+
+  if(capture_thread == NULL) {
+    capture_error = capture_WriteFrame(frame);
+    return capture_error == 0;
+  }
+  thread_Barrier( );
+  capture_head = head + 1;
+  thread_Signal(capture_event);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Poll
+// ----------------------------------------------------------------------------
+byte capture_Poll( ) {
+  if(!capture_active) {
+    return CAPTURE_IDLE;
+  }
+  if(capture_error != 0) {
+    capture_Close( );
+    return CAPTURE_FAILED;
+  }
+  return CAPTURE_BUSY;
+}
+
+// ----------------------------------------------------------------------------
+// Close
+// ----------------------------------------------------------------------------
+bool capture_Close( ) {
+  if(!capture_active) {
+    return true;
+  }
+  if(capture_thread != NULL) {
+    thread_Barrier( );
+    capture_stopping = true;
+    thread_Signal(capture_event);
+    thread_Join(capture_thread);
+    capture_thread = NULL;
+    thread_ReleaseEvent(capture_event);
+    capture_event = NULL;
+  }
+  capture_active = false;
+
+  int error = capture_error;
+  if(error == 0 && !capture_WriteWaveHeader( )) {
+    error = IDS_CAPTURE2;
+    capture_errorFilename = capture_audioFilename;
+  }
+  capture_Free( );
+  if(error != 0) {
+    logger_LogError(error, capture_errorFilename);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,53 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Capture.h
+// ----------------------------------------------------------------------------
+#ifndef CAPTURE_H
+#define CAPTURE_H
+#define CAPTURE_IDLE 0
+#define CAPTURE_BUSY 1
+#define CAPTURE_FAILED 2
+#define CAPTURE_QUEUE_SIZE 8
+#define NULL 0
+
+#include <String>
+#include <Stdio.h>
+#include "State.h"
+#include "Palette.h"
+#include "Logger.h"
+#include "Thread.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern bool capture_Open(std::string videoFilename, std::string audioFilename, uint width, uint height, uint frequency, uint sampleRate, bool background);
+extern bool capture_Store(const byte* pixels, const byte* palette, const short* samples, uint length);
+extern byte capture_Poll( );
+extern bool capture_Close( );
+extern bool capture_active;
+extern uint capture_frames;
+extern uint capture_dropped;
+
+#endif
@@ -23,12 +23,20 @@
 // Cartridge.cpp
 // ----------------------------------------------------------------------------
 #include "Cartridge.h"
+#include "ProSystem.h"
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+#define CARTRIDGE_EXTENSIONS ".a78;.bin"
+#define CARTRIDGE_MAPPER_COUNT 7
 
 std::string cartridge_title;
 std::string cartridge_description;
 std::string cartridge_year;
 std::string cartridge_maker;
 std::string cartridge_digest;
+std::string cartridge_crc;
+std::string cartridge_sha1;
 std::string cartridge_filename;
 byte cartridge_type;
 byte cartridge_region;
@@ -36,9 +44,57 @@ bool cartridge_pokey;
 byte cartridge_controller[2];
 byte cartridge_bank;
 uint cartridge_flags;
+uint cartridge_cacheSize = CARTRIDGE_CACHE_SIZE;
+bool cartridge_cached = false;
 
-static byte* cartridge_buffer = NULL;
+struct CartridgeCache {
+  std::string filename;
+  uint fileSize;
+  uint modified;
+  byte* image;
+  uint imageSize;
+  const byte* buffer;
+  uint size;
+  std::string title;
+  std::string description;
+  std::string year;
+  std::string maker;
+  std::string digest;
+  std::string crc;
+  std::string sha1;
+  byte type;
+  byte region;
+  bool pokey;
+  byte controller[2];
+  uint flags;
+  uint used;
+};
+
+typedef CartridgeCache cartridgeCache;
+
+struct CartridgeMapper {
+  word trapAddress;
+  uint trapSize;
+  memoryTrap trap;
+  word bankAddress;
+  uint bankSize;
+  void (*store)( );
+};
+
+typedef CartridgeMapper cartridgeMapper;
+
+static const byte* cartridge_buffer = NULL;
 static uint cartridge_size = 0;
+static byte* cartridge_image = NULL;
+static uint cartridge_imageSize = 0;
+static void* cartridge_mapping = NULL;
+static std::string cartridge_source;
+static uint cartridge_sourceSize = 0;
+static uint cartridge_sourceModified = 0;
+static std::vector<cartridgeCache> cartridge_cache;
+static uint cartridge_cacheUsed = 0;
+static uint cartridge_cacheClock = 0;
+static const cartridgeMapper* cartridge_mapper = NULL;
 
 // ----------------------------------------------------------------------------
 // HasHeader
@@ -76,106 +132,364 @@ static uint cartridge_GetBankOffset(byte bank) {
 // ----------------------------------------------------------------------------
 // WriteBank
 // ----------------------------------------------------------------------------
-static void cartridge_WriteBank(word address, byte bank) {
-  uint offset = cartridge_GetBankOffset(bank);
+static void cartridge_WriteBank(byte bank) {
+  if(cartridge_mapper == NULL || cartridge_mapper->bankSize == 0) {
+    return;
+  }
+  uint offset = bank * cartridge_mapper->bankSize;
   if(offset < cartridge_size) {
-    memory_WriteROM(address, 16384, cartridge_buffer + offset);
+    memory_WriteROM(cartridge_mapper->bankAddress, cartridge_mapper->bankSize, cartridge_buffer + offset);
     cartridge_bank = bank;
   }
 }
 
 // ----------------------------------------------------------------------------
-// ReadHeader
+// ParseHeader
 // ----------------------------------------------------------------------------
-static void cartridge_ReadHeader(const byte* header) {
+static void cartridge_ParseHeader(const byte* header, uint size, cartridgeInfo& info) {
   char temp[33] = {0};
   for(int index = 0; index < 32; index++) {
     temp[index] = header[index + 17];  
   }
-  cartridge_title = temp;
+  info.title = temp;
   
-  cartridge_size  = header[49] << 32;
-  cartridge_size |= header[50] << 16;
-  cartridge_size |= header[51] << 8;
-  cartridge_size |= header[52];
+  info.size  = header[49] << 24;
+  info.size |= header[50] << 16;
+  info.size |= header[51] << 8;
+  info.size |= header[52];
+  if(info.size == 0 || info.size > size - 128) {
+    info.size = size - 128;
+  }
 
   if(header[53] == 0) {
-    if(cartridge_size > 131072) {
-      cartridge_type = CARTRIDGE_TYPE_SUPERCART_LARGE;
+    if(info.size > 131072) {
+      info.type = CARTRIDGE_TYPE_SUPERCART_LARGE;
     }
     else if(header[54] == 2 || header[54] == 3) {
-      cartridge_type = CARTRIDGE_TYPE_SUPERCART;
+      info.type = CARTRIDGE_TYPE_SUPERCART;
     }
     else if(header[54] == 4 || header[54] == 5 || header[54] == 6 || header[54] == 7) {
-      cartridge_type = CARTRIDGE_TYPE_SUPERCART_RAM;
+      info.type = CARTRIDGE_TYPE_SUPERCART_RAM;
     }
     else if(header[54] == 8 || header[54] == 9 || header[54] == 10 || header[54] == 11) {
-      cartridge_type = CARTRIDGE_TYPE_SUPERCART_ROM;
+      info.type = CARTRIDGE_TYPE_SUPERCART_ROM;
     }
     else {
-      cartridge_type = CARTRIDGE_TYPE_NORMAL;
+      info.type = CARTRIDGE_TYPE_NORMAL;
     }
   }
   else {
     if(header[53] == 1) {
-      cartridge_type = CARTRIDGE_TYPE_ABSOLUTE;
+      info.type = CARTRIDGE_TYPE_ABSOLUTE;
     }
     else if(header[53] == 2) {
-      cartridge_type = CARTRIDGE_TYPE_ACTIVISION;
+      info.type = CARTRIDGE_TYPE_ACTIVISION;
     }
     else {
-      cartridge_type = CARTRIDGE_TYPE_NORMAL;
+      info.type = CARTRIDGE_TYPE_NORMAL;
     }
   }
   
-  cartridge_pokey = (header[54] & 1)? true: false;
-  cartridge_controller[0] = header[55];
-  cartridge_controller[1] = header[56];
-  cartridge_region = header[57];
-  cartridge_flags = 0;
+  info.pokey = (header[54] & 1)? true: false;
+  info.controller[0] = header[55];
+  info.controller[1] = header[56];
+  info.region = header[57];
+  info.flags = 0;
+}
+
+// ----------------------------------------------------------------------------
+// ReadHeader
+// ----------------------------------------------------------------------------
+static void cartridge_ReadHeader(const byte* header, uint size) {
+  cartridgeInfo info;
+  cartridge_ParseHeader(header, size, info);
+  cartridge_title = info.title;
+  cartridge_size = info.size;
+  cartridge_type = info.type;
+  cartridge_pokey = info.pokey;
+  cartridge_controller[0] = info.controller[0];
+  cartridge_controller[1] = info.controller[1];
+  cartridge_region = info.region;
+  cartridge_flags = info.flags;
+}
+
+// ----------------------------------------------------------------------------
+// Select
+// ----------------------------------------------------------------------------
+static uint cartridge_Select(archive* handle) {
+  uint index = archive_Find(handle, CARTRIDGE_EXTENSIONS);
+  if(index != ARCHIVE_NONE) {
+    return index;
+  }
+  byte header[128];
+  for(index = 0; index < archive_GetCount(handle); index++) {
+    if(archive_Read(handle, index, header, 128) == 128 && cartridge_HasHeader(header)) {
+      return index;
+    }
+  }
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Map
+// ----------------------------------------------------------------------------
+static byte* cartridge_Map(std::string filename, uint& size) {
+#if defined(_WIN32)
+  HANDLE file = CreateFile(filename.c_str( ), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  size = GetFileSize(file, NULL);
+  if(size == 0 || size == INVALID_FILE_SIZE) {
+    CloseHandle(file);
+    return NULL;
+  }
+
+  cartridge_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if(cartridge_mapping == NULL) {
+    return NULL;
+  }
+  byte* view = (byte*)MapViewOfFile(cartridge_mapping, FILE_MAP_READ, 0, 0, 0);
+  if(view == NULL) {
+    CloseHandle(cartridge_mapping);
+    cartridge_mapping = NULL;
+  }
+  return view;
+#else
+  return NULL;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Read
+// ----------------------------------------------------------------------------
+static byte* cartridge_Read(std::string filename, uint& size) {
+  FILE *file = fopen(filename.c_str( ), "rb");
+  if(file == NULL) {
+    logger_LogError(IDS_CARTRIDGE3, filename);
+    return NULL;  
+  }
+
+  if(fseek(file, 0, SEEK_END)) {
+    fclose(file);
+    logger_LogError(IDS_CARTRIDGE4,"");
+    return NULL;
+  }
+  size = ftell(file);
+  if(fseek(file, 0, SEEK_SET)) {
+    fclose(file);
+    logger_LogError(IDS_CARTRIDGE5,"");
+    return NULL;
+  }
+  
+  byte* data = new byte[size];
+  if(fread(data, 1, size, file) != size && ferror(file)) {
+    fclose(file);
+    logger_LogError(IDS_CARTRIDGE6,"");
+    delete [ ] data;
+    return NULL;
+  }    
+
+  fclose(file);    
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// GetRange
+// ----------------------------------------------------------------------------
+static void cartridge_GetRange(const byte* data, uint size, uint& offset, uint& length) {
+  offset = 0;
+  length = size;
+  if(size > 128 && cartridge_HasHeader(data)) {
+    cartridgeInfo info;
+    cartridge_ParseHeader(data, size, info);
+    offset = 128;
+    length = info.size;
+  }
 }
 
 // ----------------------------------------------------------------------------
 // Load
 // ----------------------------------------------------------------------------
-static bool cartridge_Load(const byte* data, uint size) {
+static bool cartridge_Load(const byte* data, uint size, hashContext* context) {
   if(size <= 128) {
     logger_LogError(IDS_CARTRIDGE1,"");
     return false;
   }
 
-  cartridge_Release( );
-  
-  byte header[128] = {0};
-  for(int index = 0; index < 128; index++) {
-    header[index] = data[index];
-  }
-
-if (cartridge_CC2(header)) {
+  if (cartridge_CC2(data)) {
     logger_LogError(IDS_CARTRIDGE9,"");
     return false;
   }
 
   uint offset = 0;
-  if(cartridge_HasHeader(header)) {
-    cartridge_ReadHeader(header);
-    size -= 128;
+  if(cartridge_HasHeader(data)) {
+    cartridge_ReadHeader(data, size);
     offset = 128;
   }
   else {
     cartridge_size = size;
   }
   
-  cartridge_buffer = new byte[cartridge_size];
-  for(index = 0; index < cartridge_size; index++) {
-    cartridge_buffer[index] = data[index + offset];
+  cartridge_buffer = data + offset;
+  hashContext local;
+  if(context == NULL) {
+    hash_Initialize(local, HASH_ALL);
+    hash_Update(local, cartridge_buffer, cartridge_size);
+    context = &local;
   }
-  
-  cartridge_digest = hash_Compute(cartridge_buffer, cartridge_size);
+  hashDigest digest;
+  hash_Finalize(*context, digest);
+  cartridge_digest = digest.md5;
+  cartridge_crc = digest.crc;
+  cartridge_sha1 = digest.sha1;
+  memory_SetImage(MEMORY_IMAGE_CARTRIDGE, cartridge_buffer, cartridge_size);
   
   return true;
 }
 
+// ----------------------------------------------------------------------------
+// Identify
+// ----------------------------------------------------------------------------
+bool cartridge_Identify(const byte* data, uint size, cartridgeInfo& info) {
+  if(data == NULL || size <= 128 || cartridge_CC2(data)) {
+    return false;
+  }
+
+  uint offset = 0;
+  if(cartridge_HasHeader(data)) {
+    cartridge_ParseHeader(data, size, info);
+    offset = 128;
+  }
+  else {
+    info.title = "";
+    info.size = size;
+    info.type = CARTRIDGE_TYPE_NORMAL;
+    info.pokey = false;
+    info.controller[0] = CARTRIDGE_CONTROLLER_JOYSTICK;
+    info.controller[1] = CARTRIDGE_CONTROLLER_JOYSTICK;
+    info.region = 0;
+    info.flags = 0;
+  }
+  info.digest = hash_Compute(data + offset, info.size);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Evict
+// ----------------------------------------------------------------------------
+static void cartridge_Evict(uint budget) {
+  while(cartridge_cacheUsed > budget && !cartridge_cache.empty( )) {
+    uint oldest = 0;
+    for(uint index = 1; index < cartridge_cache.size( ); index++) {
+      if(cartridge_cache[index].used < cartridge_cache[oldest].used) {
+        oldest = index;
+      }
+    }
+    cartridge_cacheUsed -= cartridge_cache[oldest].imageSize;
+    delete [ ] cartridge_cache[oldest].image;
+    cartridge_cache.erase(cartridge_cache.begin( ) + oldest);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Park
+// ----------------------------------------------------------------------------
+static void cartridge_Park( ) {
+  if(cartridge_source.empty( ) || cartridge_buffer == NULL || cartridge_cacheSize == 0) {
+    return;
+  }
+
+  cartridgeCache entry;
+  if(cartridge_mapping != NULL) {
+    if(cartridge_size > cartridge_cacheSize) {
+      return;
+    }
+    entry.image = new byte[cartridge_size];
+    if(entry.image == NULL) {
+      return;
+    }
+    for(uint index = 0; index < cartridge_size; index++) {
+      entry.image[index] = cartridge_buffer[index];
+    }
+    entry.imageSize = cartridge_size;
+    entry.buffer = entry.image;
+  }
+  else {
+    if(cartridge_imageSize > cartridge_cacheSize) {
+      return;
+    }
+    entry.image = cartridge_image;
+    entry.imageSize = cartridge_imageSize;
+    entry.buffer = cartridge_buffer;
+    cartridge_image = NULL;
+  }
+
+  entry.filename = cartridge_source;
+  entry.fileSize = cartridge_sourceSize;
+  entry.modified = cartridge_sourceModified;
+  entry.size = cartridge_size;
+  entry.title = cartridge_title;
+  entry.description = cartridge_description;
+  entry.year = cartridge_year;
+  entry.maker = cartridge_maker;
+  entry.digest = cartridge_digest;
+  entry.crc = cartridge_crc;
+  entry.sha1 = cartridge_sha1;
+  entry.type = cartridge_type;
+  entry.region = cartridge_region;
+  entry.pokey = cartridge_pokey;
+  entry.controller[0] = cartridge_controller[0];
+  entry.controller[1] = cartridge_controller[1];
+  entry.flags = cartridge_flags;
+  entry.used = ++cartridge_cacheClock;
+  cartridge_Evict(cartridge_cacheSize - entry.imageSize);
+  cartridge_cache.push_back(entry);
+  cartridge_cacheUsed += entry.imageSize;
+}
+
+// ----------------------------------------------------------------------------
+// Restore
+// ----------------------------------------------------------------------------
+static bool cartridge_Restore(std::string filename) {
+  for(uint index = 0; index < cartridge_cache.size( ); index++) {
+    cartridgeCache& entry = cartridge_cache[index];
+    if(entry.filename != filename) {
+      continue;
+    }
+    if(entry.fileSize != cartridge_sourceSize || entry.modified != cartridge_sourceModified) {
+      cartridge_cacheUsed -= entry.imageSize;
+      delete [ ] entry.image;
+      cartridge_cache.erase(cartridge_cache.begin( ) + index);
+      return false;
+    }
+
+    cartridge_image = entry.image;
+    cartridge_imageSize = entry.imageSize;
+    cartridge_buffer = entry.buffer;
+    cartridge_size = entry.size;
+    cartridge_title = entry.title;
+    cartridge_description = entry.description;
+    cartridge_year = entry.year;
+    cartridge_maker = entry.maker;
+    cartridge_digest = entry.digest;
+    cartridge_crc = entry.crc;
+    cartridge_sha1 = entry.sha1;
+    cartridge_type = entry.type;
+    cartridge_region = entry.region;
+    cartridge_pokey = entry.pokey;
+    cartridge_controller[0] = entry.controller[0];
+    cartridge_controller[1] = entry.controller[1];
+    cartridge_flags = entry.flags;
+    cartridge_cacheUsed -= entry.imageSize;
+    cartridge_cache.erase(cartridge_cache.begin( ) + index);
+    memory_SetImage(MEMORY_IMAGE_CARTRIDGE, cartridge_buffer, cartridge_size);
+    return true;
+  }
+  return false;
+}
+
 // ----------------------------------------------------------------------------
 // Load
 // ----------------------------------------------------------------------------
@@ -187,163 +501,211 @@ bool cartridge_Load(std::string filename) {
   
   cartridge_Release( );
   logger_LogInfo(IDS_CARTRIDGE8,filename);
-  
-  byte* data = NULL;
-  uint size = archive_GetUncompressedFileSize(filename);
-  if(size == 0) {
-    FILE *file = fopen(filename.c_str( ), "rb");
-    if(file == NULL) {
-      logger_LogError(IDS_CARTRIDGE3, filename);
-      return false;  
-    }
 
-    if(fseek(file, 0, SEEK_END)) {
-      fclose(file);
-      logger_LogError(IDS_CARTRIDGE4,"");
-      return false;
-    }
-    size = ftell(file);
-    if(fseek(file, 0, SEEK_SET)) {
-      fclose(file);
-      logger_LogError(IDS_CARTRIDGE5,"");
-      return false;
-    }
+  struct stat info = {0};
+  cartridge_sourceSize = 0;
+  cartridge_sourceModified = 0;
+  bool found = stat(filename.c_str( ), &info) == 0;
+  if(found) {
+    cartridge_sourceSize = info.st_size;
+    cartridge_sourceModified = info.st_mtime;
+    cartridge_cached = cartridge_Restore(filename);
+  }
+  else {
+    cartridge_cached = false;
+  }
+  if(cartridge_cached) {
+    cartridge_filename = filename;
+    cartridge_source = filename;
+    return true;
+  }
   
-    data = new byte[size];
-    if(fread(data, 1, size, file) != size && ferror(file)) {
-      fclose(file);
-      logger_LogError(IDS_CARTRIDGE6,"");
-      cartridge_Release( );
-      delete [ ] data;
-      return false;
-    }    
-
-    fclose(file);    
+  uint size = 0;
+  hashContext context;
+  hashContext* streamed = NULL;
+  archive* handle = archive_Open(filename);
+  if(handle != NULL) {
+    uint index = cartridge_Select(handle);
+    size = archive_GetSize(handle, index);
+    cartridge_image = new byte[size];
+    hash_Initialize(context, HASH_ALL);
+    size = archive_Read(handle, index, cartridge_image, size, context, cartridge_GetRange);
+    streamed = &context;
+    archive_Close(handle);
   }
   else {
-    data = new byte[size];
-    archive_Uncompress(filename, data, size);
+    cartridge_image = cartridge_Map(filename, size);
+    if(cartridge_image == NULL) {
+      cartridge_image = cartridge_Read(filename, size);
+      if(cartridge_image == NULL) {
+        return false;
+      }
+    }
   }
+  cartridge_imageSize = size;
   
-  if(!cartridge_Load(data, size)) {
+  if(!cartridge_Load(cartridge_image, size, streamed)) {
     logger_LogError(IDS_CARTRIDGE7,"");
-    delete [ ] data;
+    cartridge_Release( );
     return false;
   }
-  if(data != NULL) {
-    delete [ ] data;
-  }
   
   cartridge_filename = filename;
+  cartridge_source = (found)? filename: "";
   return true;
 }
 
+// ----------------------------------------------------------------------------
+// StoreNormal
+// ----------------------------------------------------------------------------
+static void cartridge_StoreNormal( ) {
+  memory_WriteROM(65536 - cartridge_size, cartridge_size, cartridge_buffer);
+}
+
+// ----------------------------------------------------------------------------
+// StoreSupercart
+// ----------------------------------------------------------------------------
+static void cartridge_StoreSupercart( ) {
+  if(cartridge_GetBankOffset(7) < cartridge_size) {
+    memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StoreSupercartLarge
+// ----------------------------------------------------------------------------
+static void cartridge_StoreSupercartLarge( ) {
+  if(cartridge_GetBankOffset(8) < cartridge_size) {
+    memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(8));
+    memory_WriteROM(16384, 16384, cartridge_buffer + cartridge_GetBankOffset(0));
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StoreSupercartRam
+// ----------------------------------------------------------------------------
+static void cartridge_StoreSupercartRam( ) {
+  if(cartridge_GetBankOffset(7) < cartridge_size) {
+    memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
+    memory_ClearROM(16384, 16384);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StoreSupercartRom
+// ----------------------------------------------------------------------------
+static void cartridge_StoreSupercartRom( ) {
+  if(cartridge_GetBankOffset(7) < cartridge_size && cartridge_GetBankOffset(6) < cartridge_size) {
+    memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
+    memory_WriteROM(16384, 16384, cartridge_buffer + cartridge_GetBankOffset(6));
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StoreAbsolute
+// ----------------------------------------------------------------------------
+static void cartridge_StoreAbsolute( ) {
+  memory_WriteROM(16384, 16384, cartridge_buffer);
+  memory_WriteROM(32768, 32768, cartridge_buffer + cartridge_GetBankOffset(2));
+}
+
+// ----------------------------------------------------------------------------
+// StoreActivision
+// ----------------------------------------------------------------------------
+static void cartridge_StoreActivision( ) {
+  if(122880 < cartridge_size) {
+    memory_WriteROM(40960, 16384, cartridge_buffer);
+    memory_WriteROM(16384, 8192, cartridge_buffer + 106496);
+    memory_WriteROM(24576, 8192, cartridge_buffer + 98304);
+    memory_WriteROM(32768, 8192, cartridge_buffer + 122880);
+    memory_WriteROM(57344, 8192, cartridge_buffer + 114688);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteSupercart
+// ----------------------------------------------------------------------------
+static void cartridge_WriteSupercart(word address, byte data) {
+  if(data < 9) {
+    cartridge_WriteBank(data);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteSupercartLarge
+// ----------------------------------------------------------------------------
+static void cartridge_WriteSupercartLarge(word address, byte data) {
+  if(data < 9) {
+    cartridge_WriteBank(data + 1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteAbsolute
+// ----------------------------------------------------------------------------
+static void cartridge_WriteAbsolute(word address, byte data) {
+  if(address == 32768 && (data == 1 || data == 2)) {
+    cartridge_WriteBank(data - 1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteActivision
+// ----------------------------------------------------------------------------
+static void cartridge_WriteActivision(word address, byte data) {
+  if(address >= 65408) {
+    cartridge_WriteBank(address & 7);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WritePokey
+// ----------------------------------------------------------------------------
+static void cartridge_WritePokey(word address, byte data) {
+  if(address <= POKEY_AUDCTL) {
+    pokey_Synchronize(prosystem_GetSoundPosition( ));
+    pokey_SetRegister(address, data);
+  }
+}
+
+static const cartridgeMapper CARTRIDGE_MAPPERS[CARTRIDGE_MAPPER_COUNT] = {
+  {0, 0, NULL, 0, 0, cartridge_StoreNormal},
+  {32768, 16384, cartridge_WriteSupercart, 32768, 16384, cartridge_StoreSupercart},
+  {32768, 16384, cartridge_WriteSupercartLarge, 32768, 16384, cartridge_StoreSupercartLarge},
+  {32768, 16384, cartridge_WriteSupercart, 32768, 16384, cartridge_StoreSupercartRam},
+  {32768, 16384, cartridge_WriteSupercart, 32768, 16384, cartridge_StoreSupercartRom},
+  {32768, MEMORY_PAGE_SIZE, cartridge_WriteAbsolute, 16384, 16384, cartridge_StoreAbsolute},
+  {65280, MEMORY_PAGE_SIZE, cartridge_WriteActivision, 40960, 16384, cartridge_StoreActivision}
+};
+
+// ----------------------------------------------------------------------------
+// GetMapper
+// ----------------------------------------------------------------------------
+static const cartridgeMapper* cartridge_GetMapper( ) {
+  return (cartridge_type < CARTRIDGE_MAPPER_COUNT)? &CARTRIDGE_MAPPERS[cartridge_type]: NULL;
+}
+
 // ----------------------------------------------------------------------------
 // Store
 // ----------------------------------------------------------------------------
 void cartridge_Store( ) {
-  switch(cartridge_type) {
-    case CARTRIDGE_TYPE_NORMAL:
-      memory_WriteROM(65536 - cartridge_size, cartridge_size, cartridge_buffer);
-      break;
-    case CARTRIDGE_TYPE_SUPERCART:
-      if(cartridge_GetBankOffset(7) < cartridge_size) {
-        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
-      }
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_LARGE:
-      if(cartridge_GetBankOffset(8) < cartridge_size) {
-        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(8));
-        memory_WriteROM(16384, 16384, cartridge_buffer + cartridge_GetBankOffset(0));
-      }
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_RAM:
-      if(cartridge_GetBankOffset(7) < cartridge_size) {
-        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
-        memory_ClearROM(16384, 16384);
-      }
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_ROM:
-      if(cartridge_GetBankOffset(7) < cartridge_size && cartridge_GetBankOffset(6) < cartridge_size) {
-        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
-        memory_WriteROM(16384, 16384, cartridge_buffer + cartridge_GetBankOffset(6));
-      }
-      break;
-    case CARTRIDGE_TYPE_ABSOLUTE:
-      memory_WriteROM(16384, 16384, cartridge_buffer);
-      memory_WriteROM(32768, 32768, cartridge_buffer + cartridge_GetBankOffset(2));
-      break;
-    case CARTRIDGE_TYPE_ACTIVISION:
-      if(122880 < cartridge_size) {
-        memory_WriteROM(40960, 16384, cartridge_buffer);
-        memory_WriteROM(16384, 8192, cartridge_buffer + 106496);
-        memory_WriteROM(24576, 8192, cartridge_buffer + 98304);
-        memory_WriteROM(32768, 8192, cartridge_buffer + 122880);
-        memory_WriteROM(57344, 8192, cartridge_buffer + 114688);
-      }
-      break;
+  cartridge_mapper = cartridge_GetMapper( );
+  if(cartridge_mapper != NULL) {
+    cartridge_mapper->store( );
   }
 }
 
 // ----------------------------------------------------------------------------
-// Write
+// Install
 // ----------------------------------------------------------------------------
-void cartridge_Write(word address, byte data) {
-  switch(cartridge_type) {
-    case CARTRIDGE_TYPE_SUPERCART:
-    case CARTRIDGE_TYPE_SUPERCART_RAM:
-    case CARTRIDGE_TYPE_SUPERCART_ROM:
-      if(address >= 32768 && address < 49152 && data < 9) {
-        cartridge_StoreBank(data);
-      }
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_LARGE:
-      if(address >= 32768 && address < 49152 && data < 9) {
-        cartridge_StoreBank(data + 1);
-      }
-      break;
-    case CARTRIDGE_TYPE_ABSOLUTE:
-      if(address == 32768 && (data == 1 || data == 2)) {
-        cartridge_StoreBank(data - 1);
-      }
-      break;
-    case CARTRIDGE_TYPE_ACTIVISION:
-      if(address >= 65408) {
-        cartridge_StoreBank(address & 7);
-      }
-      break;
-  }
-
-  if(cartridge_pokey && address >= 0x4000 && address < 0x4009) {
-    switch(address) {
-      case POKEY_AUDF1:
-        pokey_SetRegister(POKEY_AUDF1, data);
-        break;
-      case POKEY_AUDC1:
-        pokey_SetRegister(POKEY_AUDC1, data);
-        break;
-      case POKEY_AUDF2:
-        pokey_SetRegister(POKEY_AUDF2, data);
-        break;
-      case POKEY_AUDC2:
-        pokey_SetRegister(POKEY_AUDC2, data);
-        break;
-      case POKEY_AUDF3:
-        pokey_SetRegister(POKEY_AUDF3, data);
-        break;
-      case POKEY_AUDC3:
-        pokey_SetRegister(POKEY_AUDC3, data);
-        break;
-      case POKEY_AUDF4:
-        pokey_SetRegister(POKEY_AUDF4, data);
-        break;
-      case POKEY_AUDC4:
-        pokey_SetRegister(POKEY_AUDC4, data);
-        break;
-      case POKEY_AUDCTL:
-        pokey_SetRegister(POKEY_AUDCTL, data);
-        break;
-    }
+void cartridge_Install( ) {
+  memory_SetTrap(0, MEMORY_SIZE, NULL);
+  cartridge_mapper = cartridge_GetMapper( );
+  if(cartridge_mapper != NULL && cartridge_mapper->trap != NULL) {
+    memory_SetTrap(cartridge_mapper->trapAddress, cartridge_mapper->trapSize, cartridge_mapper->trap);
+  }
+  if(cartridge_pokey) {
+    memory_SetTrap(POKEY_AUDF1, MEMORY_PAGE_SIZE, cartridge_WritePokey);
   }
 }
 
@@ -351,26 +713,8 @@ void cartridge_Write(word address, byte data) {
 // StoreBank
 // ----------------------------------------------------------------------------
 void cartridge_StoreBank(byte bank) {
-  switch(cartridge_type) {
-    case CARTRIDGE_TYPE_SUPERCART:
-      cartridge_WriteBank(32768, bank);
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_RAM:
-      cartridge_WriteBank(32768, bank);
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_ROM:
-      cartridge_WriteBank(32768, bank);
-      break;
-    case CARTRIDGE_TYPE_SUPERCART_LARGE:
-      cartridge_WriteBank(32768, bank);        
-      break;
-    case CARTRIDGE_TYPE_ABSOLUTE:
-      cartridge_WriteBank(16384, bank);
-      break;
-    case CARTRIDGE_TYPE_ACTIVISION:
-      cartridge_WriteBank(40960, bank);
-      break;
-  }  
+  cartridge_mapper = cartridge_GetMapper( );
+  cartridge_WriteBank(bank);
 }
 
 // ----------------------------------------------------------------------------
@@ -384,9 +728,48 @@ bool cartridge_IsLoaded( ) {
 // Release
 // ----------------------------------------------------------------------------
 void cartridge_Release( ) {
+  cartridge_Park( );
+  cartridge_source = "";
+  memory_SetTrap(0, MEMORY_SIZE, NULL);
+  if(cartridge_mapping != NULL) {
+#if defined(_WIN32)
+    UnmapViewOfFile(cartridge_image);
+    CloseHandle(cartridge_mapping);
+#endif
+    cartridge_mapping = NULL;
+  }
+  else if(cartridge_image != NULL) {
+    delete [ ] cartridge_image;
+  }
+  cartridge_image = NULL;
   if(cartridge_buffer != NULL) {
-    delete [ ] cartridge_buffer;
     cartridge_size = 0;
     cartridge_buffer = NULL;
+    memory_SetImage(MEMORY_IMAGE_CARTRIDGE, NULL, 0);
   }
 }
+
+// ----------------------------------------------------------------------------
+// ReleaseCache
+// ----------------------------------------------------------------------------
+void cartridge_ReleaseCache( ) {
+  cartridge_Evict(0);
+}
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint cartridge_SaveState(byte* buffer) {
+  uint offset = 0;
+  state_WriteByte(buffer, offset, cartridge_bank);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint cartridge_LoadState(const byte* buffer) {
+  uint offset = 0;
+  cartridge_bank = state_ReadByte(buffer, offset);
+  return offset;
+}
@@ -36,28 +36,53 @@
 #define CARTRIDGE_CONTROLLER_LIGHTGUN 2
 #define CARTRIDGE_WSYNC_MASK 2
 #define CARTRIDGE_CYCLE_STEALING_MASK 1
+#define CARTRIDGE_STATE_SIZE 1
+#define CARTRIDGE_CACHE_SIZE 8388608
 #define NULL 0
 
 #include <Stdio.h>
 #include <String>
+#include <Vector>
+#include <Sys/Types.h>
+#include <Sys/Stat.h>
 #include "Equates.h"
 #include "Memory.h"
 #include "Hash.h"
 #include "Logger.h"
 #include "Pokey.h"
 #include "Archive.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
 typedef unsigned int uint;
 
+struct CartridgeInfo {
+  std::string digest;
+  std::string title;
+  uint size;
+  byte type;
+  bool pokey;
+  byte controller[2];
+  byte region;
+  uint flags;
+};
+
+typedef CartridgeInfo cartridgeInfo;
+
 extern bool cartridge_Load(std::string filename);
+extern bool cartridge_Identify(const byte* data, uint size, cartridgeInfo& info);
 extern void cartridge_Store( );
 extern void cartridge_StoreBank(byte bank);
-extern void cartridge_Write(word address, byte data);
+extern void cartridge_Install( );
 extern bool cartridge_IsLoaded( );
 extern void cartridge_Release( );
+extern void cartridge_ReleaseCache( );
+extern uint cartridge_SaveState(byte* buffer);
+extern uint cartridge_LoadState(const byte* buffer);
 extern std::string cartridge_digest;
+extern std::string cartridge_crc;
+extern std::string cartridge_sha1;
 extern std::string cartridge_title;
 extern std::string cartridge_description;
 extern std::string cartridge_year;
@@ -69,5 +94,7 @@ extern bool cartridge_pokey;
 extern byte cartridge_controller[2];
 extern byte cartridge_bank;
 extern uint cartridge_flags;
+extern uint cartridge_cacheSize;
+extern bool cartridge_cached;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,299 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Checksum.cpp
+// ----------------------------------------------------------------------------
+#include "Checksum.h"
+#define CHECKSUM_QWORD(high, low) (((qword)(high) << 32) | (low))
+#define CHECKSUM_PRIME CHECKSUM_QWORD(0x9e3779b9, 0x7f4a7c15)
+#define CHECKSUM_HEADER "PRO-SYSTEM TRACE"
+#define CHECKSUM_VERSION 1
+#define CHECKSUM_HEADER_SIZE (16 + 1 + 32)
+#define CHECKSUM_RECORD_SIZE (4 + 8 + 2)
+#define CHECKSUM_ENTRY_SIZE (2 + 8)
+#define CHECKSUM_REGISTERS_SIZE (((MACHINE_REGISTERS_SIZE + 7) >> 3) << 3)
+
+qword checksum_value = 0;
+uint checksum_frame = 0;
+
+static qword checksum_pages[MEMORY_PAGE_COUNT + 1];
+static qword checksum_traced[MEMORY_PAGE_COUNT + 1];
+static qword checksum_memory = 0;
+static uint checksum_epoch = 0;
+static bool checksum_valid = false;
+static FILE* checksum_file = NULL;
+
+// ----------------------------------------------------------------------------
+// Mix
+// ----------------------------------------------------------------------------
+static qword checksum_Mix(qword hash) {
+  hash ^= hash >> 33;
+  hash *= CHECKSUM_QWORD(0xff51afd7, 0xed558ccd);
+  hash ^= hash >> 33;
+  hash *= CHECKSUM_QWORD(0xc4ceb9fe, 0x1a85ec53);
+  hash ^= hash >> 33;
+  return hash;
+}
+
+// ----------------------------------------------------------------------------
+// Hash
+// ----------------------------------------------------------------------------
+static qword checksum_Hash(const byte* data, uint size, qword seed) {
+  qword hash = checksum_Mix(seed);
+  uint offset = 0;
+  while(offset < size) {
+    uint low = state_ReadUint(data, offset);
+    hash = (hash ^ CHECKSUM_QWORD(state_ReadUint(data, offset), low)) * CHECKSUM_PRIME;
+    hash ^= hash >> 29;
+  }
+  return checksum_Mix(hash);
+}
+
+// ----------------------------------------------------------------------------
+// WriteQword
+// ----------------------------------------------------------------------------
+static void checksum_WriteQword(byte* buffer, uint& offset, qword data) {
+  state_WriteUint(buffer, offset, (uint)data);
+  state_WriteUint(buffer, offset, (uint)(data >> 32));
+}
+
+// ----------------------------------------------------------------------------
+// ReadQword
+// ----------------------------------------------------------------------------
+static qword checksum_ReadQword(const byte* buffer, uint& offset) {
+  uint low = state_ReadUint(buffer, offset);
+  return CHECKSUM_QWORD(state_ReadUint(buffer, offset), low);
+}
+
+// ----------------------------------------------------------------------------
+// Compute
+// ----------------------------------------------------------------------------
+qword checksum_Compute( ) {
+  uint page;
+  if(!checksum_valid || memory_IsDirty(checksum_epoch)) {
+    for(page = 0; page < MEMORY_PAGE_COUNT; page++) {
+      if(checksum_valid && !memory_IsDirty(page, checksum_epoch)) {
+        continue;
+      }
+      qword hash = checksum_Hash(memory_ram + (page << 8), MEMORY_PAGE_SIZE, (page << 1) | memory_rom[page]);
+      checksum_memory += hash - checksum_pages[page];
+      checksum_pages[page] = hash;
+    }
+    checksum_epoch = memory_Checkpoint( );
+    checksum_valid = true;
+  }
+
+  byte registers[CHECKSUM_REGISTERS_SIZE] = {0};
+  machine_SaveRegisters(registers);
+  checksum_pages[CHECKSUM_REGISTERS] = checksum_Hash(registers, CHECKSUM_REGISTERS_SIZE, CHECKSUM_REGISTERS << 1);
+  checksum_value = checksum_Mix(checksum_memory ^ checksum_pages[CHECKSUM_REGISTERS]);
+  return checksum_value;
+}
+
+// ----------------------------------------------------------------------------
+// GetPage
+// ----------------------------------------------------------------------------
+qword checksum_GetPage(uint page) {
+  return (page <= CHECKSUM_REGISTERS)? checksum_pages[page]: 0;
+}
+
+// ----------------------------------------------------------------------------
+// Open
+// ----------------------------------------------------------------------------
+bool checksum_Open(std::string filename) {
+  checksum_Close( );
+  checksum_file = fopen(filename.c_str( ), "wb");
+  if(checksum_file == NULL) {
+    logger_LogError(IDS_CHECKSUM1,filename);
+    return false;
+  }
+
+  byte header[CHECKSUM_HEADER_SIZE];
+  uint offset = 0;
+  state_WriteBytes(header, offset, (const byte*)CHECKSUM_HEADER, 16);
+  state_WriteByte(header, offset, CHECKSUM_VERSION);
+  for(uint index = 0; index < 32; index++) {
+    state_WriteByte(header, offset, (index < cartridge_digest.size( ))? cartridge_digest[index]: 0);
+  }
+  if(fwrite(header, 1, offset, checksum_file) != offset) {
+    logger_LogError(IDS_CHECKSUM1,filename);
+    checksum_Close( );
+    return false;
+  }
+
+  for(uint page = 0; page <= CHECKSUM_REGISTERS; page++) {
+    checksum_traced[page] = 0;
+  }
+  checksum_frame = 0;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Store
+// ----------------------------------------------------------------------------
+void checksum_Store( ) {
+  if(checksum_file == NULL) {
+    return;
+  }
+
+  checksum_Compute( );
+  byte record[CHECKSUM_RECORD_SIZE + ((MEMORY_PAGE_COUNT + 1) * CHECKSUM_ENTRY_SIZE)];
+  uint offset = CHECKSUM_RECORD_SIZE;
+  word count = 0;
+  for(uint page = 0; page <= CHECKSUM_REGISTERS; page++) {
+    if(checksum_pages[page] != checksum_traced[page] || checksum_frame == 0) {
+      state_WriteWord(record, offset, page);
+      checksum_WriteQword(record, offset, checksum_pages[page]);
+      checksum_traced[page] = checksum_pages[page];
+      count++;
+    }
+  }
+
+  uint size = offset;
+  offset = 0;
+  state_WriteUint(record, offset, checksum_frame);
+  checksum_WriteQword(record, offset, checksum_value);
+  state_WriteWord(record, offset, count);
+  if(fwrite(record, 1, size, checksum_file) != size) {
+    logger_LogError(IDS_CHECKSUM1,"");
+    checksum_Close( );
+    return;
+  }
+  checksum_frame++;
+}
+
+// ----------------------------------------------------------------------------
+// Close
+// ----------------------------------------------------------------------------
+void checksum_Close( ) {
+  if(checksum_file != NULL) {
+    fclose(checksum_file);
+    checksum_file = NULL;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ReadRecord
+// ----------------------------------------------------------------------------
+static bool checksum_ReadRecord(FILE* file, qword* pages, uint& frame, qword& value) {
+  byte record[CHECKSUM_RECORD_SIZE];
+  if(fread(record, 1, CHECKSUM_RECORD_SIZE, file) != CHECKSUM_RECORD_SIZE) {
+    return false;
+  }
+  uint offset = 0;
+  frame = state_ReadUint(record, offset);
+  value = checksum_ReadQword(record, offset);
+  word count = state_ReadWord(record, offset);
+  for(uint index = 0; index < count; index++) {
+    byte entry[CHECKSUM_ENTRY_SIZE];
+    if(fread(entry, 1, CHECKSUM_ENTRY_SIZE, file) != CHECKSUM_ENTRY_SIZE) {
+      return false;
+    }
+    offset = 0;
+    word page = state_ReadWord(entry, offset);
+    if(page > CHECKSUM_REGISTERS) {
+      return false;
+    }
+    pages[page] = checksum_ReadQword(entry, offset);
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// OpenTrace
+// ----------------------------------------------------------------------------
+static FILE* checksum_OpenTrace(std::string filename) {
+  FILE* file = fopen(filename.c_str( ), "rb");
+  if(file == NULL) {
+    logger_LogError(IDS_CHECKSUM2,filename);
+    return NULL;
+  }
+  byte header[CHECKSUM_HEADER_SIZE];
+  bool valid = fread(header, 1, CHECKSUM_HEADER_SIZE, file) == CHECKSUM_HEADER_SIZE && header[16] == CHECKSUM_VERSION;
+  for(uint index = 0; index < 16 && valid; index++) {
+    valid = (header[index] == CHECKSUM_HEADER[index]);
+  }
+  if(!valid) {
+    logger_LogError(IDS_CHECKSUM2,filename);
+    fclose(file);
+    return NULL;
+  }
+  return file;
+}
+
+// ----------------------------------------------------------------------------
+// Compare
+// ----------------------------------------------------------------------------
+bool checksum_Compare(std::string first, std::string second, uint& frame, uint& page) {
+  frame = CHECKSUM_NONE;
+  page = CHECKSUM_NONE;
+  FILE* files[2];
+  files[0] = checksum_OpenTrace(first);
+  if(files[0] == NULL) {
+    return false;
+  }
+  files[1] = checksum_OpenTrace(second);
+  if(files[1] == NULL) {
+    fclose(files[0]);
+    return false;
+  }
+
+  static qword pages[2][MEMORY_PAGE_COUNT + 1];
+  uint index;
+  for(index = 0; index <= CHECKSUM_REGISTERS; index++) {
+    pages[0][index] = 0;
+    pages[1][index] = 0;
+  }
+
+  uint frames[2];
+  qword values[2];
+  while(true) {
+    bool first = checksum_ReadRecord(files[0], pages[0], frames[0], values[0]);
+    bool second = checksum_ReadRecord(files[1], pages[1], frames[1], values[1]);
+    if(!first && !second) {
+      break;
+    }
+    if(!first || !second || frames[0] != frames[1]) {
+      if(!first || (second && frames[1] < frames[0])) {
+        frame = frames[1];
+      }
+      else {
+        frame = frames[0];
+      }
+      break;
+    }
+    if(values[0] != values[1]) {
+      frame = frames[0];
+      for(index = 0; index <= CHECKSUM_REGISTERS; index++) {
+        if(pages[0][index] != pages[1][index]) {
+          page = index;
+          break;
+        }
+      }
+      break;
+    }
+  }
+  fclose(files[0]);
+  fclose(files[1]);
+  return true;
+}
@@ -0,0 +1,57 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Checksum.h
+// ----------------------------------------------------------------------------
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+#define CHECKSUM_REGISTERS MEMORY_PAGE_COUNT
+#define CHECKSUM_NONE 0xffffffff
+#define NULL 0
+
+#include <String>
+#include <Stdio.h>
+#include "Memory.h"
+#include "Machine.h"
+#include "Cartridge.h"
+#include "Logger.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+#if defined(_MSC_VER)
+typedef unsigned __int64 qword;
+#else
+typedef unsigned long long qword;
+#endif
+
+extern qword checksum_Compute( );
+extern qword checksum_GetPage(uint page);
+extern bool checksum_Open(std::string filename);
+extern void checksum_Store( );
+extern void checksum_Close( );
+extern bool checksum_Compare(std::string first, std::string second, uint& frame, uint& page);
+extern qword checksum_value;
+extern uint checksum_frame;
+
+#endif
@@ -23,6 +23,10 @@
 // Hash.cpp
 // ----------------------------------------------------------------------------
 #include "Hash.h"
+#define HASH_CRC32_POLYNOMIAL 0xedb88320
+
+static uint hash_crcTable[8][256];
+static bool hash_crcInitialized = false;
 
 // ----------------------------------------------------------------------------
 // Step1
@@ -67,7 +71,7 @@ static uint hash_Step4(uint w, uint x, uint y, uint z, uint data, uint s) {
 // ----------------------------------------------------------------------------
 // Transform
 // ----------------------------------------------------------------------------
-static void hash_Transform(uint out[4], uint in[16]) {
+static void hash_Transform(uint out[4], const uint in[16]) {
   uint a, b, c, d;
 
   a = out[0];
@@ -150,87 +154,267 @@ static void hash_Transform(uint out[4], uint in[16]) {
 }
 
 // ----------------------------------------------------------------------------
-// Compute
+// Rotate
 // ----------------------------------------------------------------------------
-std::string hash_Compute(const byte* source, uint length) {
-  uint buffer1[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
-  uint buffer2[2] = {0};
-  byte buffer3[64] = {0};
-
-  uint temp = buffer2[0];
-  if((buffer2[0] = temp + ((uint)length << 3)) < temp) {
-	  buffer2[1]++;
-  }
-  buffer2[1] += length >> 29;
-
-  temp = (temp >> 3) & 0x3f;
-  if(temp) {
-	  byte* ptr = (byte*)buffer3 + temp;
-	  temp = 64 - temp;
-	  if(length < temp) {
-      for(uint index = 0; index < length; index++) {
-        ptr[index] = source[index];
-      }
-	  }
-	  
-    for(uint index = 0; index < temp; index++) {
-      ptr[index] = source[index];
-    }
+static uint hash_Rotate(uint value, uint count) {
+  return value << count | value >> (32 - count);
+}
 
-	  hash_Transform(buffer1, (uint*)buffer3);
-	  source += temp;
-	  length -= temp;
+// ----------------------------------------------------------------------------
+// TransformSha1
+// ----------------------------------------------------------------------------
+static void hash_TransformSha1(uint out[5], const byte* block) {
+  uint in[80];
+  uint index;
+  for(index = 0; index < 16; index++) {
+    in[index] = block[index << 2] << 24 | block[(index << 2) + 1] << 16 | block[(index << 2) + 2] << 8 | block[(index << 2) + 3];
+  }
+  for(index = 16; index < 80; index++) {
+    in[index] = hash_Rotate(in[index - 3] ^ in[index - 8] ^ in[index - 14] ^ in[index - 16], 1);
   }
 
-  while(length >= 64) {
-    for(uint index = 0; index < 64; index++) {
-      buffer3[index] = source[index];
+  uint a = out[0];
+  uint b = out[1];
+  uint c = out[2];
+  uint d = out[3];
+  uint e = out[4];
+  for(index = 0; index < 20; index++) {
+    uint temp = hash_Rotate(a, 5) + (d ^ (b & (c ^ d))) + e + in[index] + 0x5a827999;
+    e = d;
+    d = c;
+    c = hash_Rotate(b, 30);
+    b = a;
+    a = temp;
+  }
+  for(index = 20; index < 40; index++) {
+    uint temp = hash_Rotate(a, 5) + (b ^ c ^ d) + e + in[index] + 0x6ed9eba1;
+    e = d;
+    d = c;
+    c = hash_Rotate(b, 30);
+    b = a;
+    a = temp;
+  }
+  for(index = 40; index < 60; index++) {
+    uint temp = hash_Rotate(a, 5) + ((b & c) | (d & (b | c))) + e + in[index] + 0x8f1bbcdc;
+    e = d;
+    d = c;
+    c = hash_Rotate(b, 30);
+    b = a;
+    a = temp;
+  }
+  for(index = 60; index < 80; index++) {
+    uint temp = hash_Rotate(a, 5) + (b ^ c ^ d) + e + in[index] + 0xca62c1d6;
+    e = d;
+    d = c;
+    c = hash_Rotate(b, 30);
+    b = a;
+    a = temp;
+  }
+
+  out[0] += a;
+  out[1] += b;
+  out[2] += c;
+  out[3] += d;
+  out[4] += e;
+}
+
+// ----------------------------------------------------------------------------
+// TransformMd5
+// ----------------------------------------------------------------------------
+static void hash_TransformMd5(uint out[4], const byte* block) {
+  uint in[16];
+  for(uint index = 0; index < 16; index++) {
+    in[index] = block[index << 2] | block[(index << 2) + 1] << 8 | block[(index << 2) + 2] << 16 | block[(index << 2) + 3] << 24;
+  }
+  hash_Transform(out, in);
+}
+
+// ----------------------------------------------------------------------------
+// InitializeCrc
+// ----------------------------------------------------------------------------
+static void hash_InitializeCrc( ) {
+  uint index;
+  for(index = 0; index < 256; index++) {
+    uint value = index;
+    for(uint bit = 0; bit < 8; bit++) {
+      value = (value & 1)? (value >> 1) ^ HASH_CRC32_POLYNOMIAL: value >> 1;
     }
-	  hash_Transform(buffer1, (uint*)buffer3);
-	  source += 64;
-	  length -= 64;
+    hash_crcTable[0][index] = value;
+  }
+  for(index = 0; index < 256; index++) {
+    for(uint slice = 1; slice < 8; slice++) {
+      hash_crcTable[slice][index] = (hash_crcTable[slice - 1][index] >> 8) ^ hash_crcTable[0][hash_crcTable[slice - 1][index] & 255];
+    }
+  }
+  hash_crcInitialized = true;
+}
+
+// ----------------------------------------------------------------------------
+// UpdateCrc
+// ----------------------------------------------------------------------------
+static uint hash_UpdateCrc(uint crc, const byte* data, uint length) {
+  while(length >= 8) {
+    uint one = (data[0] | data[1] << 8 | data[2] << 16 | data[3] << 24) ^ crc;
+    uint two = data[4] | data[5] << 8 | data[6] << 16 | data[7] << 24;
+    crc  = hash_crcTable[7][one & 255] ^ hash_crcTable[6][(one >> 8) & 255] ^ hash_crcTable[5][(one >> 16) & 255] ^ hash_crcTable[4][one >> 24];
+    crc ^= hash_crcTable[3][two & 255] ^ hash_crcTable[2][(two >> 8) & 255] ^ hash_crcTable[1][(two >> 16) & 255] ^ hash_crcTable[0][two >> 24];
+    data += 8;
+    length -= 8;
+  }
+  while(length != 0) {
+    crc = (crc >> 8) ^ hash_crcTable[0][(crc ^ *data++) & 255];
+    length--;
+  }
+  return crc;
+}
+
+// ----------------------------------------------------------------------------
+// TransformBlock
+// ----------------------------------------------------------------------------
+static void hash_TransformBlock(hashContext& context, const byte* block) {
+  if(context.algorithms & HASH_MD5) {
+    hash_TransformMd5(context.md5, block);
   }
+  if(context.algorithms & HASH_SHA1) {
+    hash_TransformSha1(context.sha1, block);
+  }
+}
 
-  for(uint index = 0; index < length; index++) {
-    buffer3[index] = source[index];
+// ----------------------------------------------------------------------------
+// Format
+// ----------------------------------------------------------------------------
+static std::string hash_Format(const byte* digest, uint size) {
+  char buffer[41] = {0};
+  for(uint index = 0; index < size; index++) {
+    sprintf(buffer + (index << 1), "%02x", digest[index]);
   }
+  return std::string(buffer);
+}
 
-  uint count = (buffer2[0] >> 3) & 0x3f;
-  byte* ptr = buffer3 + count;
-  *ptr++ = 0x80;
+// ----------------------------------------------------------------------------
+// Initialize
+// ----------------------------------------------------------------------------
+void hash_Initialize(hashContext& context, byte algorithms) {
+  if(!hash_crcInitialized && (algorithms & HASH_CRC32)) {
+    hash_InitializeCrc( );
+  }
+  context.algorithms = algorithms;
+  context.md5[0] = 0x67452301;
+  context.md5[1] = 0xefcdab89;
+  context.md5[2] = 0x98badcfe;
+  context.md5[3] = 0x10325476;
+  context.sha1[0] = 0x67452301;
+  context.sha1[1] = 0xefcdab89;
+  context.sha1[2] = 0x98badcfe;
+  context.sha1[3] = 0x10325476;
+  context.sha1[4] = 0xc3d2e1f0;
+  context.crc = 0xffffffff;
+  context.length[0] = 0;
+  context.length[1] = 0;
+}
 
-  count = 63 - count;
+// ----------------------------------------------------------------------------
+// Update
+// ----------------------------------------------------------------------------
+void hash_Update(hashContext& context, const byte* data, uint length) {
+  if(context.algorithms & HASH_CRC32) {
+    context.crc = hash_UpdateCrc(context.crc, data, length);
+  }
 
-  if(count < 8) {
-    uint index;
-    for(index = 0; index < count; index++) {
-      ptr[index] = 0;
+  uint used = context.length[0] & 63;
+  if((context.length[0] += length) < length) {
+    context.length[1]++;
+  }
+  if(!(context.algorithms & (HASH_MD5 | HASH_SHA1))) {
+    return;
+  }
+
+  uint index;
+  if(used != 0) {
+    uint count = 64 - used;
+    if(length < count) {
+      count = length;
     }
-	  hash_Transform(buffer1, (uint*)buffer3);
-    
-    for(index = 0; index < 56; index++) {
-      buffer3[index] = 0;
+    for(index = 0; index < count; index++) {
+      context.block[used + index] = data[index];
     }
-  } 
-  else {
-    for(index = 0; index < count - 8; index++) {
-      ptr[index] = 0;
+    data += count;
+    length -= count;
+    if(used + count < 64) {
+      return;
     }
+    hash_TransformBlock(context, context.block);
   }
 
-  ((uint*)buffer3)[14] = buffer2[0];
-  ((uint*)buffer3)[15] = buffer2[1];
+  while(length >= 64) {
+    hash_TransformBlock(context, data);
+    data += 64;
+    length -= 64;
+  }
+  for(index = 0; index < length; index++) {
+    context.block[index] = data[index];
+  }
+}
 
-  hash_Transform(buffer1, (uint*)buffer3);
-  
-  byte digest[16];
-  byte* bufferptr = (byte*)buffer1;
-  for(index = 0; index < 16; index++) {
-    digest[index] = bufferptr[index];
+// ----------------------------------------------------------------------------
+// Finalize
+// ----------------------------------------------------------------------------
+void hash_Finalize(hashContext& context, hashDigest& digest) {
+  byte buffer[128] = {0};
+  uint used = context.length[0] & 63;
+  uint index;
+  for(index = 0; index < used; index++) {
+    buffer[index] = context.block[index];
   }
+  buffer[used] = 0x80;
+  uint size = (used < 56)? 64: 128;
+  uint low = context.length[0] << 3;
+  uint high = context.length[1] << 3 | context.length[0] >> 29;
 
-  char buffer[33] = {0};
-  sprintf(buffer, "%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", digest[0], digest[1], digest[2], digest[3], digest[4], digest[5], digest[6], digest[7], digest[8], digest[9], digest[10], digest[11], digest[12], digest[13], digest[14], digest[15]);
-  return std::string(buffer);
+  byte result[20];
+  if(context.algorithms & HASH_MD5) {
+    for(index = 0; index < 4; index++) {
+      buffer[size - 8 + index] = (low >> (index << 3)) & 255;
+      buffer[size - 4 + index] = (high >> (index << 3)) & 255;
+    }
+    for(index = 0; index < size; index += 64) {
+      hash_TransformMd5(context.md5, buffer + index);
+    }
+    for(index = 0; index < 16; index++) {
+      result[index] = (context.md5[index >> 2] >> ((index & 3) << 3)) & 255;
+    }
+    digest.md5 = hash_Format(result, 16);
+  }
+  if(context.algorithms & HASH_SHA1) {
+    for(index = 0; index < 4; index++) {
+      buffer[size - 5 - index] = (high >> (index << 3)) & 255;
+      buffer[size - 1 - index] = (low >> (index << 3)) & 255;
+    }
+    for(index = 0; index < size; index += 64) {
+      hash_TransformSha1(context.sha1, buffer + index);
+    }
+    for(index = 0; index < 20; index++) {
+      result[index] = (context.sha1[index >> 2] >> ((3 - (index & 3)) << 3)) & 255;
+    }
+    digest.sha1 = hash_Format(result, 20);
+  }
+  if(context.algorithms & HASH_CRC32) {
+    uint crc = context.crc ^ 0xffffffff;
+    for(index = 0; index < 4; index++) {
+      result[index] = (crc >> ((3 - index) << 3)) & 255;
+    }
+    digest.crc = hash_Format(result, 4);
+  }
 }
 
+// ----------------------------------------------------------------------------
+// Compute
+// ----------------------------------------------------------------------------
+std::string hash_Compute(const byte* source, uint length) {
+  hashContext context;
+  hashDigest digest;
+  hash_Initialize(context, HASH_MD5);
+  hash_Update(context, source, length);
+  hash_Finalize(context, digest);
+  return digest.md5;
+}
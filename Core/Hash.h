@@ -24,13 +24,39 @@
 // ----------------------------------------------------------------------------
 #ifndef HASH_H
 #define HASH_H
+#define HASH_MD5 1
+#define HASH_CRC32 2
+#define HASH_SHA1 4
+#define HASH_ALL 7
 
+#include <Stdio.h>
 #include <String>
 
 typedef unsigned char byte;
 typedef unsigned short word;
 typedef unsigned int uint;
 
+struct HashContext {
+  byte algorithms;
+  uint md5[4];
+  uint sha1[5];
+  uint crc;
+  uint length[2];
+  byte block[64];
+};
+
+struct HashDigest {
+  std::string md5;
+  std::string crc;
+  std::string sha1;
+};
+
+typedef HashContext hashContext;
+typedef HashDigest hashDigest;
+
+extern void hash_Initialize(hashContext& context, byte algorithms);
+extern void hash_Update(hashContext& context, const byte* data, uint length);
+extern void hash_Finalize(hashContext& context, hashDigest& digest);
 extern std::string hash_Compute(const byte* source, uint length);
 
 #endif
\ No newline at end of file
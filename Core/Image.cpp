@@ -0,0 +1,343 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Image.cpp
+// ----------------------------------------------------------------------------
+#include "Image.h"
+#define IMAGE_PNG_OVERHEAD 57
+#define IMAGE_BMP_HEADER_SIZE 54
+
+static thread* image_thread = NULL;
+static byte* image_pixels = NULL;
+static uint image_pixelsCapacity = 0;
+static byte* image_output = NULL;
+static uint image_outputCapacity = 0;
+static uint image_width = 0;
+static uint image_height = 0;
+static byte image_format = IMAGE_FORMAT_BMP;
+static std::string image_filename;
+static int image_error = 0;
+
+// ----------------------------------------------------------------------------
+// GetFormat
+// ----------------------------------------------------------------------------
+static byte image_GetFormat(std::string filename) {
+  std::string::size_type position = filename.rfind('.');
+  std::string extension = (position != std::string::npos)? filename.substr(position): "";
+  for(uint index = 0; index < extension.size( ); index++) {
+    extension[index] = tolower(extension[index]);
+  }
+  if(extension == ".png") {
+    return IMAGE_FORMAT_PNG;
+  }
+  if(extension == ".ppm") {
+    return IMAGE_FORMAT_PPM;
+  }
+  return IMAGE_FORMAT_BMP;
+}
+
+// ----------------------------------------------------------------------------
+// Reserve
+// ----------------------------------------------------------------------------
+static bool image_Reserve(byte*& buffer, uint& capacity, uint size) {
+  if(size > capacity) {
+    delete [ ] buffer;
+    buffer = new byte[size];
+    if(buffer == NULL) {
+      capacity = 0;
+      return false;
+    }
+    capacity = size;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// WriteLong
+// ----------------------------------------------------------------------------
+static void image_WriteLong(byte* buffer, uint& offset, uint value) {
+  buffer[offset++] = value >> 24;
+  buffer[offset++] = (value >> 16) & 255;
+  buffer[offset++] = (value >> 8) & 255;
+  buffer[offset++] = value & 255;
+}
+
+// ----------------------------------------------------------------------------
+// WriteChunk
+// ----------------------------------------------------------------------------
+static void image_WriteChunk(byte* buffer, uint& offset, const char* type, uint size) {
+  uint start = offset;
+  image_WriteLong(buffer, offset, size);
+  for(uint index = 0; index < 4; index++) {
+    buffer[offset++] = type[index];
+  }
+  offset += size;
+  image_WriteLong(buffer, offset, crc32(0, buffer + start + 4, size + 4));
+}
+
+// ----------------------------------------------------------------------------
+// EncodePng
+// ----------------------------------------------------------------------------
+static uint image_EncodePng( ) {
+  uint pitch = image_width * 3;
+  uint rawSize = (pitch + 1) * image_height;
+  uLong bound = compressBound(rawSize);
+  if(!image_Reserve(image_output, image_outputCapacity, rawSize + bound + IMAGE_PNG_OVERHEAD)) {
+    return 0;
+  }
+
+  byte* raw = image_output + bound + IMAGE_PNG_OVERHEAD;
+  uint index;
+  for(index = 0; index < image_height; index++) {
+    byte* row = raw + (index * (pitch + 1));
+    const byte* source = image_pixels + (index * pitch);
+    row[0] = 0;
+    for(uint column = 0; column < pitch; column++) {
+      row[column + 1] = source[column];
+    }
+  }
+
+  const byte SIGNATURE[ ] = {137, 80, 78, 71, 13, 10, 26, 10};
+  uint offset = 0;
+  for(index = 0; index < 8; index++) {
+    image_output[offset++] = SIGNATURE[index];
+  }
+
+  uint start = offset;
+  offset += 8;
+  image_WriteLong(image_output, offset, image_width);
+  image_WriteLong(image_output, offset, image_height);
+  image_output[offset++] = 8;
+  image_output[offset++] = 2;
+  image_output[offset++] = 0;
+  image_output[offset++] = 0;
+  image_output[offset++] = 0;
+  offset = start;
+  image_WriteChunk(image_output, offset, "IHDR", 13);
+
+  uLongf size = bound;
+  if(compress2(image_output + offset + 8, &size, raw, rawSize, IMAGE_LEVEL) != Z_OK) {
+    return 0;
+  }
+  image_WriteChunk(image_output, offset, "IDAT", size);
+  image_WriteChunk(image_output, offset, "IEND", 0);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// EncodePpm
+// ----------------------------------------------------------------------------
+static uint image_EncodePpm( ) {
+  char header[32];
+  uint headerSize = sprintf(header, "P6\n%u %u\n255\n", image_width, image_height);
+  uint size = image_width * image_height * 3;
+  if(!image_Reserve(image_output, image_outputCapacity, headerSize + size)) {
+    return 0;
+  }
+  uint index;
+  for(index = 0; index < headerSize; index++) {
+    image_output[index] = header[index];
+  }
+  for(index = 0; index < size; index++) {
+    image_output[headerSize + index] = image_pixels[index];
+  }
+  return headerSize + size;
+}
+
+// ----------------------------------------------------------------------------
+// EncodeBmp
+// ----------------------------------------------------------------------------
+static uint image_EncodeBmp( ) {
+  uint pitch = ((image_width * 3) + 3) & ~3;
+  uint size = IMAGE_BMP_HEADER_SIZE + (pitch * image_height);
+  if(!image_Reserve(image_output, image_outputCapacity, size)) {
+    return 0;
+  }
+
+  uint offset = 0;
+  image_output[offset++] = 'B';
+  image_output[offset++] = 'M';
+  state_WriteUint(image_output, offset, size);
+  state_WriteUint(image_output, offset, 0);
+  state_WriteUint(image_output, offset, IMAGE_BMP_HEADER_SIZE);
+  state_WriteUint(image_output, offset, 40);
+  state_WriteUint(image_output, offset, image_width);
+  state_WriteUint(image_output, offset, image_height);
+  state_WriteWord(image_output, offset, 1);
+  state_WriteWord(image_output, offset, 24);
+  for(uint index = 0; index < 6; index++) {
+    state_WriteUint(image_output, offset, 0);
+  }
+
+  for(uint row = image_height; row-- != 0; ) {
+    const byte* source = image_pixels + (row * image_width * 3);
+    byte* target = image_output + offset;
+    uint column;
+    for(column = 0; column < image_width * 3; column += 3) {
+      target[column + 0] = source[column + 2];
+      target[column + 1] = source[column + 1];
+      target[column + 2] = source[column + 0];
+    }
+    for(; column < pitch; column++) {
+      target[column] = 0;
+    }
+    offset += pitch;
+  }
+  return size;
+}
+
+// ----------------------------------------------------------------------------
+// Flush
+// ----------------------------------------------------------------------------
+static int image_Flush( ) {
+  uint size;
+  switch(image_format) {
+    case IMAGE_FORMAT_PNG:
+      size = image_EncodePng( );
+      break;
+    case IMAGE_FORMAT_PPM:
+      size = image_EncodePpm( );
+      break;
+    default:
+      size = image_EncodeBmp( );
+      break;
+  }
+  if(size == 0) {
+    return IDS_IMAGE2;
+  }
+
+  FILE* file = fopen(image_filename.c_str( ), "wb");
+  if(file == NULL) {
+    return IDS_IMAGE1;
+  }
+  if(fwrite(image_output, 1, size, file) != size) {
+    fclose(file);
+    return IDS_IMAGE2;
+  }
+  fclose(file);
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+static void image_Run( ) {
+  image_error = image_Flush( );
+}
+
+// ----------------------------------------------------------------------------
+// Finish
+// ----------------------------------------------------------------------------
+static byte image_Finish( ) {
+  thread_Join(image_thread);
+  image_thread = NULL;
+  if(image_error != 0) {
+    logger_LogError(image_error, image_filename);
+    return IMAGE_FAILED;
+  }
+  return IMAGE_DONE;
+}
+
+// ----------------------------------------------------------------------------
+// Convert
+// ----------------------------------------------------------------------------
+uint image_Convert(byte* target) {
+  uint size = maria_visibleArea.GetArea( );
+  const byte* source = maria_surface + (maria_visibleArea.top - maria_displayArea.top) * maria_visibleArea.GetLength( );
+  for(uint index = 0; index < size; index++) {
+    const byte* color = palette_data + (source[index] * 3);
+    target[0] = color[0];
+    target[1] = color[1];
+    target[2] = color[2];
+    target += 3;
+  }
+  return size * 3;
+}
+
+// ----------------------------------------------------------------------------
+// Save
+// ----------------------------------------------------------------------------
+bool image_Save(std::string filename) {
+  if(filename.empty( )) {
+    logger_LogError(IDS_IMAGE1,filename);
+    return false;
+  }
+  image_Wait( );
+
+  if(!image_Reserve(image_pixels, image_pixelsCapacity, maria_visibleArea.GetArea( ) * 3)) {
+    logger_LogError(IDS_IMAGE2,filename);
+    return false;
+  }
+  image_Convert(image_pixels);
+  image_width = maria_visibleArea.GetLength( );
+  image_height = maria_visibleArea.GetHeight( );
+  image_format = image_GetFormat(filename);
+  image_filename = filename;
+  image_error = 0;
+
+  image_thread = thread_Create(image_Run);
+  if(image_thread == NULL) {
+    image_error = image_Flush( );
+    if(image_error != 0) {
+      logger_LogError(image_error, filename);
+      return false;
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Poll
+// ----------------------------------------------------------------------------
+byte image_Poll( ) {
+  if(image_thread == NULL) {
+    return IMAGE_IDLE;
+  }
+  if(!thread_IsDone(image_thread)) {
+    return IMAGE_BUSY;
+  }
+  return image_Finish( );
+}
+
+// ----------------------------------------------------------------------------
+// Wait
+// ----------------------------------------------------------------------------
+bool image_Wait( ) {
+  if(image_thread == NULL) {
+    return true;
+  }
+  return image_Finish( ) == IMAGE_DONE;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void image_Release( ) {
+  image_Wait( );
+  delete [ ] image_pixels;
+  image_pixels = NULL;
+  image_pixelsCapacity = 0;
+  delete [ ] image_output;
+  image_output = NULL;
+  image_outputCapacity = 0;
+}
@@ -0,0 +1,57 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Image.h
+// ----------------------------------------------------------------------------
+#ifndef IMAGE_H
+#define IMAGE_H
+#define IMAGE_IDLE 0
+#define IMAGE_BUSY 1
+#define IMAGE_DONE 2
+#define IMAGE_FAILED 3
+#define IMAGE_FORMAT_BMP 0
+#define IMAGE_FORMAT_PNG 1
+#define IMAGE_FORMAT_PPM 2
+#define IMAGE_LEVEL Z_BEST_SPEED
+#define NULL 0
+
+#include <String>
+#include <Stdio.h>
+#include <Ctype.h>
+#include "Maria.h"
+#include "Palette.h"
+#include "Logger.h"
+#include "Zlib.h"
+#include "Thread.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern uint image_Convert(byte* target);
+extern bool image_Save(std::string filename);
+extern byte image_Poll( );
+extern bool image_Wait( );
+extern void image_Release( );
+
+#endif
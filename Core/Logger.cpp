@@ -23,6 +23,9 @@
 // Logger.cpp
 // ----------------------------------------------------------------------------
 #include "Logger.h"
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
 #define LOGGER_FILENAME "ProSystem.log"
 
 byte logger_level = LOGGER_LEVEL_DEBUG;
@@ -39,6 +42,18 @@ static std::string logger_GetTime( ) {
   return timestring.erase(timestring.find_first_of("\n"), 1);
 }
 
+// ----------------------------------------------------------------------------
+// GetString
+// ----------------------------------------------------------------------------
+static std::string logger_GetString(int message) {
+#if defined(_WIN32)
+  LoadString(GetModuleHandle(NULL),message, a, 180);
+#else
+  sprintf(a, "#%d", message);
+#endif
+  return a;
+}
+
 // ----------------------------------------------------------------------------
 // Log
 // ----------------------------------------------------------------------------
@@ -88,8 +103,7 @@ bool logger_Initialize(std::string filename) {
 // ----------------------------------------------------------------------------
 void logger_LogError(int message, std::string source) {
   if(logger_level == LOGGER_LEVEL_ERROR || logger_level == LOGGER_LEVEL_INFO || logger_level == LOGGER_LEVEL_DEBUG) {
-	LoadString(GetModuleHandle(NULL),message, a, 180);
-	std::string b(a);
+    std::string b = logger_GetString(message);
     logger_Log(b, LOGGER_LEVEL_ERROR, source);
   }
 }
@@ -109,8 +123,7 @@ void logger_LogError(std::string message, std::string source) {
 // ----------------------------------------------------------------------------
 void logger_LogInfo(int message, std::string source) {
   if(logger_level == LOGGER_LEVEL_INFO || logger_level == LOGGER_LEVEL_DEBUG) {
-	LoadString(GetModuleHandle(NULL),message, a, 180);
-		std::string b(a);
+    std::string b = logger_GetString(message);
     logger_Log(b, LOGGER_LEVEL_INFO, source);
   }
 }
@@ -129,8 +142,7 @@ void logger_LogInfo(std::string message, std::string source) {
 // ----------------------------------------------------------------------------
 void logger_LogDebug(int message, std::string source) {
   if(logger_level == LOGGER_LEVEL_DEBUG) {
-	LoadString(GetModuleHandle(NULL),message, a, 180);
-		std::string b(a);
+    std::string b = logger_GetString(message);
     logger_Log(b, LOGGER_LEVEL_DEBUG, source);
   }
 }
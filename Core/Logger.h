@@ -32,7 +32,6 @@
 #include <Stdio.h>
 #include <String>
 #include <Time.h>
-#include "Windows.h"
 #include "Resource.h"
 
 
@@ -0,0 +1,294 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Machine.cpp
+// ----------------------------------------------------------------------------
+#include "Machine.h"
+
+struct MachinePage {
+  uint references;
+  byte ram[MEMORY_PAGE_SIZE];
+  byte rom;
+  const byte* source;
+  MachinePage* next;
+};
+
+struct MachineTable {
+  uint references;
+  MachinePage* pages[MEMORY_PAGE_COUNT];
+  MachineTable* older;
+  MachineTable* next;
+};
+
+struct Machine {
+  MachineTable* table;
+  byte state[MACHINE_REGISTERS_SIZE];
+  Machine* next;
+};
+
+typedef MachinePage machinePage;
+typedef MachineTable machineTable;
+
+static machineTable* machine_tables = NULL;
+static machineTable* machine_current = NULL;
+static machinePage* machine_freePages = NULL;
+static machineTable* machine_freeTables = NULL;
+static machine* machine_freeForks = NULL;
+
+// ----------------------------------------------------------------------------
+// AllocatePage
+// ----------------------------------------------------------------------------
+static machinePage* machine_AllocatePage( ) {
+  machinePage* page = machine_freePages;
+  if(page != NULL) {
+    machine_freePages = page->next;
+  }
+  else {
+    page = new machinePage;
+    if(page == NULL) {
+      logger_LogError(IDS_MACHINE1,"");
+      return NULL;
+    }
+  }
+  page->references = 1;
+  return page;
+}
+
+// ----------------------------------------------------------------------------
+// ReleasePage
+// ----------------------------------------------------------------------------
+static void machine_ReleasePage(machinePage* page) {
+  if(page != NULL && --page->references == 0) {
+    page->next = machine_freePages;
+    machine_freePages = page;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// AllocateTable
+// ----------------------------------------------------------------------------
+static machineTable* machine_AllocateTable( ) {
+  machineTable* table = machine_freeTables;
+  if(table != NULL) {
+    machine_freeTables = table->next;
+  }
+  else {
+    table = new machineTable;
+    if(table == NULL) {
+      logger_LogError(IDS_MACHINE1,"");
+      return NULL;
+    }
+  }
+  for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+    table->pages[page] = NULL;
+  }
+  table->references = 1;
+  table->older = machine_tables;
+  machine_tables = table;
+  return table;
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseTable
+// ----------------------------------------------------------------------------
+static void machine_ReleaseTable(machineTable* table) {
+  if(table != NULL && --table->references == 0) {
+    machineTable** link = &machine_tables;
+    while(*link != table) {
+      link = &(*link)->older;
+    }
+    *link = table->older;
+    if(machine_current == table) {
+      machine_current = NULL;
+    }
+    for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+      machine_ReleasePage(table->pages[page]);
+    }
+    table->next = machine_freeTables;
+    machine_freeTables = table;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Preserve
+// ----------------------------------------------------------------------------
+void machine_Preserve(byte page) {
+  machine_current = NULL;
+  machinePage* copy = NULL;
+  for(machineTable* table = machine_tables; table != NULL; table = table->older) {
+    if(table->pages[page] != NULL) {
+      continue;
+    }
+    if(copy == NULL) {
+      copy = machine_AllocatePage( );
+      if(copy == NULL) {
+        return;
+      }
+      memcpy(copy->ram, memory_ram + (page << 8), MEMORY_PAGE_SIZE);
+      copy->rom = memory_rom[page];
+      copy->source = memory_source[page];
+    }
+    else {
+      copy->references++;
+    }
+    table->pages[page] = copy;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// SaveRegisters
+// ----------------------------------------------------------------------------
+uint machine_SaveRegisters(byte* buffer) {
+  uint offset = 0;
+  state_WriteByte(buffer, offset, prosystem_frame);
+  state_WriteUint(buffer, offset, prosystem_cycles);
+  offset += sally_SaveState(buffer + offset);
+  offset += cartridge_SaveState(buffer + offset);
+  offset += maria_SaveState(buffer + offset);
+  offset += riot_SaveState(buffer + offset);
+  offset += tia_SaveState(buffer + offset);
+  offset += pokey_SaveState(buffer + offset);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// LoadRegisters
+// ----------------------------------------------------------------------------
+uint machine_LoadRegisters(const byte* buffer) {
+  uint offset = 0;
+  prosystem_frame = state_ReadByte(buffer, offset);
+  prosystem_cycles = state_ReadUint(buffer, offset);
+  offset += sally_LoadState(buffer + offset);
+  offset += cartridge_LoadState(buffer + offset);
+  offset += maria_LoadState(buffer + offset);
+  offset += riot_LoadState(buffer + offset);
+  offset += tia_LoadState(buffer + offset);
+  offset += pokey_LoadState(buffer + offset);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// Fork
+// ----------------------------------------------------------------------------
+machine* machine_Fork( ) {
+  machine* fork = machine_freeForks;
+  if(fork != NULL) {
+    machine_freeForks = fork->next;
+  }
+  else {
+    fork = new machine;
+    if(fork == NULL) {
+      logger_LogError(IDS_MACHINE1,"");
+      return NULL;
+    }
+  }
+
+  if(machine_current != NULL) {
+    machine_current->references++;
+  }
+  else {
+    machine_current = machine_AllocateTable( );
+    if(machine_current == NULL) {
+      fork->next = machine_freeForks;
+      machine_freeForks = fork;
+      return NULL;
+    }
+    memory_Checkpoint( );
+  }
+  fork->table = machine_current;
+  machine_SaveRegisters(fork->state);
+  fork->next = NULL;
+  return fork;
+}
+
+// ----------------------------------------------------------------------------
+// Load
+// ----------------------------------------------------------------------------
+bool machine_Load(const machine* fork) {
+  if(fork == NULL) {
+    return false;
+  }
+
+  machineTable* table = fork->table;
+  if(table != machine_current) {
+    for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+      machinePage* source = table->pages[page];
+      if(source == NULL) {
+        continue;
+      }
+      memory_SetDirty(page << 8, MEMORY_PAGE_SIZE);
+      memcpy(memory_ram + (page << 8), source->ram, MEMORY_PAGE_SIZE);
+      memory_rom[page] = source->rom;
+      memory_source[page] = source->source;
+    }
+    machine_current = table;
+    memory_Checkpoint( );
+  }
+
+  machine_LoadRegisters(fork->state);
+  prosystem_active = true;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void machine_Release(machine* fork) {
+  if(fork != NULL) {
+    machine_ReleaseTable(fork->table);
+    fork->next = machine_freeForks;
+    machine_freeForks = fork;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// IsCurrent
+// ----------------------------------------------------------------------------
+bool machine_IsCurrent(const machine* fork) {
+  if(fork == NULL || fork->table != machine_current) {
+    return false;
+  }
+  byte state[MACHINE_REGISTERS_SIZE];
+  uint size = machine_SaveRegisters(state);
+  return memcmp(state, fork->state, size) == 0;
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void machine_Reset( ) {
+  while(machine_freePages != NULL) {
+    machinePage* page = machine_freePages;
+    machine_freePages = page->next;
+    delete page;
+  }
+  while(machine_freeTables != NULL) {
+    machineTable* table = machine_freeTables;
+    machine_freeTables = table->next;
+    delete table;
+  }
+  while(machine_freeForks != NULL) {
+    machine* fork = machine_freeForks;
+    machine_freeForks = fork->next;
+    delete fork;
+  }
+}
@@ -0,0 +1,50 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Machine.h
+// ----------------------------------------------------------------------------
+#ifndef MACHINE_H
+#define MACHINE_H
+#define MACHINE_REGISTERS_SIZE (5 + SALLY_STATE_SIZE + CARTRIDGE_STATE_SIZE + MARIA_STATE_SIZE + RIOT_STATE_SIZE + TIA_STATE_SIZE + POKEY_STATE_SIZE)
+#define NULL 0
+
+#include <String.h>
+#include "ProSystem.h"
+#include "Logger.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+struct Machine;
+typedef Machine machine;
+
+extern machine* machine_Fork( );
+extern bool machine_Load(const machine* fork);
+extern void machine_Release(machine* fork);
+extern bool machine_IsCurrent(const machine* fork);
+extern void machine_Preserve(byte page);
+extern void machine_Reset( );
+extern uint machine_SaveRegisters(byte* buffer);
+extern uint machine_LoadRegisters(const byte* buffer);
+
+#endif
@@ -29,6 +29,7 @@ rect maria_displayArea = {0, 16, 319, 258};
 rect maria_visibleArea = {0, 26, 319, 248};
 byte maria_surface[MARIA_SURFACE_SIZE] = {0};
 word maria_scanline = 1;
+bool maria_rendering = true;
 
 static byte maria_lineRAM[MARIA_LINERAM_SIZE];
 static uint maria_cycles;
@@ -280,7 +281,7 @@ uint maria_RenderScanline( ) {
         sally_ExecuteNMI( );
       }
     }
-    else if(maria_scanline >= maria_visibleArea.top && maria_scanline <= maria_visibleArea.bottom) {
+    else if(maria_rendering && maria_scanline >= maria_visibleArea.top && maria_scanline <= maria_visibleArea.bottom) {
       maria_WriteLineRAM(maria_surface + ((maria_scanline - maria_displayArea.top) * maria_displayArea.GetLength( )));
     }
     if(maria_scanline != maria_displayArea.bottom) {
@@ -309,4 +310,44 @@ void maria_Clear( ) {
   for(int index = 0; index < MARIA_SURFACE_SIZE; index++) {
     maria_surface[index] = 0;
   }
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint maria_SaveState(byte* buffer) {
+  uint offset = 0;
+  state_WriteBytes(buffer, offset, maria_lineRAM, MARIA_LINERAM_SIZE);
+  state_WriteUint(buffer, offset, maria_cycles);
+  state_WriteWord(buffer, offset, maria_dpp.w);
+  state_WriteWord(buffer, offset, maria_dp.w);
+  state_WriteWord(buffer, offset, maria_pp.w);
+  state_WriteByte(buffer, offset, maria_horizontal);
+  state_WriteByte(buffer, offset, maria_palette);
+  state_WriteByte(buffer, offset, maria_offset);
+  state_WriteByte(buffer, offset, maria_h08);
+  state_WriteByte(buffer, offset, maria_h16);
+  state_WriteByte(buffer, offset, maria_wmode);
+  state_WriteWord(buffer, offset, maria_scanline);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint maria_LoadState(const byte* buffer) {
+  uint offset = 0;
+  state_ReadBytes(buffer, offset, maria_lineRAM, MARIA_LINERAM_SIZE);
+  maria_cycles = state_ReadUint(buffer, offset);
+  maria_dpp.w = state_ReadWord(buffer, offset);
+  maria_dp.w = state_ReadWord(buffer, offset);
+  maria_pp.w = state_ReadWord(buffer, offset);
+  maria_horizontal = state_ReadByte(buffer, offset);
+  maria_palette = state_ReadByte(buffer, offset);
+  maria_offset = state_ReadByte(buffer, offset);
+  maria_h08 = state_ReadByte(buffer, offset);
+  maria_h16 = state_ReadByte(buffer, offset);
+  maria_wmode = state_ReadByte(buffer, offset);
+  maria_scanline = state_ReadWord(buffer, offset);
+  return offset;
+}
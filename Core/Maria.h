@@ -24,6 +24,7 @@
 // ----------------------------------------------------------------------------
 #ifndef MARIA_H
 #define MARIA_H
+#define MARIA_STATE_SIZE 178
 #define MARIA_SURFACE_SIZE 93440
 
 #include "Equates.h"
@@ -31,6 +32,7 @@
 #include "Memory.h"
 #include "Rect.h"
 #include "Sally.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -39,9 +41,12 @@ typedef unsigned int uint;
 extern void maria_Reset( );
 extern uint maria_RenderScanline( );
 extern void maria_Clear( );
+extern uint maria_SaveState(byte* buffer);
+extern uint maria_LoadState(const byte* buffer);
 extern rect maria_displayArea;
 extern rect maria_visibleArea;
 extern byte maria_surface[MARIA_SURFACE_SIZE];
 extern word maria_scanline;
+extern bool maria_rendering;
 
 #endif
\ No newline at end of file
@@ -23,21 +23,47 @@
 // Memory.cpp
 // ----------------------------------------------------------------------------
 #include "Memory.h"
+#include "ProSystem.h"
+
+#define MEMORY_PAGE_ROM 1
+#define MEMORY_PAGE_RAW 0
+#define MEMORY_PAGE_ZERO 2
+#define MEMORY_PAGE_IMAGE 4
+#define MEMORY_PAGE_BIOS 8
+#define MEMORY_PAGE_MASK 15
 
 byte memory_ram[MEMORY_SIZE] = {0};
-byte memory_rom[MEMORY_SIZE] = {0};
+byte memory_rom[MEMORY_PAGE_COUNT] = {0};
+const byte* memory_source[MEMORY_PAGE_COUNT] = {0};
+uint memory_stamp[MEMORY_PAGE_COUNT] = {0};
+uint memory_epoch = 1;
+
+static const byte* memory_image[MEMORY_IMAGE_COUNT] = {0};
+static memoryTrap memory_trap[MEMORY_PAGE_COUNT] = {0};
+static uint memory_imageSize[MEMORY_IMAGE_COUNT] = {0};
+
+#define memory_Touch(address) ((memory_stamp[(address) >> 8] != memory_epoch)? memory_Stamp((address) >> 8): (void)0)
+
+// ----------------------------------------------------------------------------
+// Stamp
+// ----------------------------------------------------------------------------
+static void memory_Stamp(byte page) {
+  machine_Preserve(page);
+  memory_stamp[page] = memory_epoch;
+}
 
 // ----------------------------------------------------------------------------
 // Reset
 // ----------------------------------------------------------------------------
 void memory_Reset( ) {
   uint index;
+  memory_SetDirty(0, MEMORY_SIZE);
   for(index = 0; index < MEMORY_SIZE; index++) {
     memory_ram[index] = 0;
-    memory_rom[index] = 1;
   }
-  for(index = 0; index < 16384; index++) {
-    memory_rom[index] = 0;
+  for(index = 0; index < MEMORY_PAGE_COUNT; index++) {
+    memory_rom[index] = (index >= (16384 >> 8));
+    memory_source[index] = NULL;
   }
 }
 // ----------------------------------------------------------------------------
@@ -49,12 +75,14 @@ byte memory_Read(word address) {
   switch ( address ) {
   case INTIM:
   case INTIM | 0x2:
+	memory_Touch(INTFLG);
 	memory_ram[INTFLG] &= 0x7f;
     return memory_ram[INTIM];
 	break;
   case INTFLG:
   case INTFLG | 0x2:
 	 tmp_byte = memory_ram[INTFLG];
+	 memory_Touch(INTFLG);
 	 memory_ram[INTFLG] &= 0x7f;
 	 return tmp_byte; 
      break;
@@ -68,16 +96,18 @@ byte memory_Read(word address) {
 // Write
 // ----------------------------------------------------------------------------
 void memory_Write(word address, byte data) {
-  if(!memory_rom[address]) {
+  if(!memory_rom[address >> 8]) {
     switch(address) {
       case WSYNC:
         if(!(cartridge_flags & 128)) {
+          memory_Touch(WSYNC);
           memory_ram[WSYNC] = true;
         }
         break;
       case INPTCTRL:
         if(data == 22 && cartridge_IsLoaded( )) { 
           cartridge_Store( ); 
+          bios_handoff = bios_enabled;
         }
         else if(data == 2 && bios_enabled) {
           bios_Store( );
@@ -96,22 +126,13 @@ void memory_Write(word address, byte data) {
       case INPT5:
         break;
       case AUDC0:
-        tia_SetRegister(AUDC0, data);
-        break;
       case AUDC1:
-        tia_SetRegister(AUDC1, data);
-        break;
       case AUDF0:
-        tia_SetRegister(AUDF0, data);
-        break;
       case AUDF1:
-        tia_SetRegister(AUDF1, data);
-        break;
       case AUDV0:
-        tia_SetRegister(AUDV0, data);
-        break;
       case AUDV1:
-        tia_SetRegister(AUDV1, data);
+        tia_Synchronize(prosystem_GetSoundPosition( ));
+        tia_SetRegister(address, data);
         break;
       case SWCHB:
         break;
@@ -134,24 +155,29 @@ void memory_Write(word address, byte data) {
         riot_SetTimer(T1024T, data);
         break;
       default:
+        memory_Touch(address);
         memory_ram[address] = data;
         if(address >= 8256 && address <= 8447) {
+          memory_Touch(address - 8192);
           memory_ram[address - 8192] = data;
         }
         else if(address >= 8512 && address <= 8702) {
+          memory_Touch(address - 8192);
           memory_ram[address - 8192] = data;
         }
         else if(address >= 64 && address <= 255) {
+          memory_Touch(address + 8192);
           memory_ram[address + 8192] = data;
         }
         else if(address >= 320 && address <= 511) {
+          memory_Touch(address + 8192);
           memory_ram[address + 8192] = data;
         }
         break;
     }
   }
-  else {
-    cartridge_Write(address, data);
+  else if(memory_trap[address >> 8] != NULL) {
+    memory_trap[address >> 8](address, data);
   }
 }
 
@@ -159,10 +185,27 @@ void memory_Write(word address, byte data) {
 // WriteROM
 // ----------------------------------------------------------------------------
 void memory_WriteROM(word address, word size, const byte* data) {
-  if((address + size) <= MEMORY_SIZE && data != NULL) {
-    for(uint index = 0; index < size; index++) {
+  if((address + size) <= MEMORY_SIZE && data != NULL && size != 0) {
+    uint index;
+    memory_SetDirty(address, size);
+    for(index = 0; index < size; index++) {
       memory_ram[address + index] = data[index];
-      memory_rom[address + index] = 1;
+    }
+    for(index = address >> 8; index <= (address + size - 1u) >> 8; index++) {
+      bool full = (index << 8) >= address && (index << 8) + MEMORY_PAGE_SIZE <= address + size;
+      memory_source[index] = (full)? data + ((index << 8) - address): NULL;
+      memory_rom[index] = 1;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// SetTrap
+// ----------------------------------------------------------------------------
+void memory_SetTrap(word address, uint size, memoryTrap trap) {
+  if(address + size <= MEMORY_SIZE && size != 0) {
+    for(uint index = address >> 8; index <= (address + size - 1u) >> 8; index++) {
+      memory_trap[index] = trap;
     }
   }
 }
@@ -171,10 +214,222 @@ void memory_WriteROM(word address, word size, const byte* data) {
 // ClearROM
 // ----------------------------------------------------------------------------
 void memory_ClearROM(word address, word size) {
-  if((address + size) <= MEMORY_SIZE) {
-    for(uint index = 0; index < size; index++) {
+  if((address + size) <= MEMORY_SIZE && size != 0) {
+    uint index;
+    memory_SetDirty(address, size);
+    for(index = 0; index < size; index++) {
       memory_ram[address + index] = 0;
-      memory_rom[address + index] = 0;
     }
+    for(index = address >> 8; index <= (address + size - 1u) >> 8; index++) {
+      memory_source[index] = NULL;
+      memory_rom[index] = 0;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// FindImage
+// ----------------------------------------------------------------------------
+static bool memory_FindImage(const byte* source, byte& image, uint& offset) {
+  if(source != NULL) {
+    for(image = 0; image < MEMORY_IMAGE_COUNT; image++) {
+      const byte* data = memory_image[image];
+      if(data != NULL && source >= data && source + MEMORY_PAGE_SIZE <= data + memory_imageSize[image]) {
+        offset = source - data;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// IsZero
+// ----------------------------------------------------------------------------
+static bool memory_IsZero(const byte* data) {
+  byte bits = 0;
+  for(uint index = 0; index < MEMORY_PAGE_SIZE; index++) {
+    bits |= data[index];
+  }
+  return bits == 0;
+}
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint memory_SaveState(byte* buffer) {
+  uint offset = MEMORY_PAGE_COUNT;
+  for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+    const byte* data = memory_ram + (page << 8);
+    byte kind = memory_rom[page];
+    byte image;
+    uint source;
+    if(memory_FindImage(memory_source[page], image, source)) {
+      kind |= MEMORY_PAGE_IMAGE | ((image == MEMORY_IMAGE_BIOS)? MEMORY_PAGE_BIOS: 0);
+      state_WriteUint(buffer, offset, source);
+    }
+    else if(memory_IsZero(data)) {
+      kind |= MEMORY_PAGE_ZERO;
+    }
+    else {
+      state_WriteBytes(buffer, offset, data, MEMORY_PAGE_SIZE);
+    }
+    buffer[page] = kind;
+  }
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// CheckState
+// ----------------------------------------------------------------------------
+bool memory_CheckState(const byte* buffer, uint size) {
+  if(size == MEMORY_STATE_SIZE) {
+    return true;
+  }
+  if(size < MEMORY_PAGE_COUNT) {
+    return false;
+  }
+  uint offset = MEMORY_PAGE_COUNT;
+  for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+    byte kind = buffer[page];
+    if(kind > MEMORY_PAGE_MASK || (kind & (MEMORY_PAGE_IMAGE | MEMORY_PAGE_BIOS)) == MEMORY_PAGE_BIOS) {
+      return false;
+    }
+    if(kind & MEMORY_PAGE_IMAGE) {
+      byte image = (kind & MEMORY_PAGE_BIOS)? MEMORY_IMAGE_BIOS: MEMORY_IMAGE_CARTRIDGE;
+      if(offset + 4 > size) {
+        return false;
+      }
+      uint source = state_ReadUint(buffer, offset);
+      if(memory_image[image] == NULL || source > memory_imageSize[image] || memory_imageSize[image] - source < MEMORY_PAGE_SIZE) {
+        return false;
+      }
+    }
+    else if(!(kind & MEMORY_PAGE_ZERO)) {
+      if(offset + MEMORY_PAGE_SIZE > size) {
+        return false;
+      }
+      offset += MEMORY_PAGE_SIZE;
+    }
+  }
+  return offset == size;
+}
+
+// ----------------------------------------------------------------------------
+// UsesImage
+// ----------------------------------------------------------------------------
+bool memory_UsesImage(const byte* buffer, uint size, byte image) {
+  if(size == MEMORY_STATE_SIZE || size < MEMORY_PAGE_COUNT) {
+    return false;
+  }
+  for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+    byte kind = buffer[page];
+    if((kind & MEMORY_PAGE_IMAGE) && ((kind & MEMORY_PAGE_BIOS)? MEMORY_IMAGE_BIOS: MEMORY_IMAGE_CARTRIDGE) == image) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint memory_LoadState(const byte* buffer, uint size) {
+  uint offset = 0;
+  uint page;
+  memory_SetDirty(0, MEMORY_SIZE);
+  if(size == MEMORY_STATE_SIZE) {
+    state_ReadBytes(buffer, offset, memory_ram, MEMORY_SIZE);
+    for(page = 0; page < MEMORY_PAGE_COUNT; page++) {
+      const byte* flags = buffer + offset + (page << 5);
+      byte rom = 0;
+      for(uint index = 0; index < (MEMORY_PAGE_SIZE >> 3); index++) {
+        rom |= flags[index];
+      }
+      memory_rom[page] = (rom != 0);
+      memory_source[page] = NULL;
+    }
+    return size;
+  }
+
+  offset = MEMORY_PAGE_COUNT;
+  for(page = 0; page < MEMORY_PAGE_COUNT; page++) {
+    byte* data = memory_ram + (page << 8);
+    byte kind = buffer[page];
+    memory_rom[page] = kind & MEMORY_PAGE_ROM;
+    memory_source[page] = NULL;
+    if(kind & MEMORY_PAGE_IMAGE) {
+      const byte* source = memory_image[(kind & MEMORY_PAGE_BIOS)? MEMORY_IMAGE_BIOS: MEMORY_IMAGE_CARTRIDGE] + state_ReadUint(buffer, offset);
+      for(uint index = 0; index < MEMORY_PAGE_SIZE; index++) {
+        data[index] = source[index];
+      }
+      memory_source[page] = source;
+    }
+    else if(kind & MEMORY_PAGE_ZERO) {
+      for(uint index = 0; index < MEMORY_PAGE_SIZE; index++) {
+        data[index] = 0;
+      }
+    }
+    else {
+      state_ReadBytes(buffer, offset, data, MEMORY_PAGE_SIZE);
+    }
+  }
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// SetImage
+// ----------------------------------------------------------------------------
+void memory_SetImage(byte image, const byte* data, uint size) {
+  if(image < MEMORY_IMAGE_COUNT) {
+    memory_image[image] = (size != 0)? data: NULL;
+    memory_imageSize[image] = (data != NULL)? size: 0;
   }
 }
+
+// ----------------------------------------------------------------------------
+// SetDirty
+// ----------------------------------------------------------------------------
+void memory_SetDirty(word address) {
+  memory_Touch(address);
+}
+
+// ----------------------------------------------------------------------------
+// SetDirty
+// ----------------------------------------------------------------------------
+void memory_SetDirty(word address, uint size) {
+  if(size != 0) {
+    uint last = (address + size - 1) >> 8;
+    if(last >= MEMORY_PAGE_COUNT) {
+      last = MEMORY_PAGE_COUNT - 1;
+    }
+    for(uint page = address >> 8; page <= last; page++) {
+      memory_Touch(page << 8);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// IsDirty
+// ----------------------------------------------------------------------------
+bool memory_IsDirty(byte page, uint epoch) {
+  return memory_stamp[page] > epoch;
+}
+
+// ----------------------------------------------------------------------------
+// IsDirty
+// ----------------------------------------------------------------------------
+bool memory_IsDirty(uint epoch) {
+  uint dirty = 0;
+  for(uint page = 0; page < MEMORY_PAGE_COUNT; page++) {
+    dirty |= (memory_stamp[page] > epoch);
+  }
+  return dirty != 0;
+}
+
+// ----------------------------------------------------------------------------
+// Checkpoint
+// ----------------------------------------------------------------------------
+uint memory_Checkpoint( ) {
+  return memory_epoch++;
+}
@@ -25,6 +25,12 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 #define MEMORY_SIZE 65536
+#define MEMORY_PAGE_SIZE 256
+#define MEMORY_PAGE_COUNT (MEMORY_SIZE / MEMORY_PAGE_SIZE)
+#define MEMORY_STATE_SIZE (MEMORY_SIZE + (MEMORY_SIZE >> 3))
+#define MEMORY_IMAGE_CARTRIDGE 0
+#define MEMORY_IMAGE_BIOS 1
+#define MEMORY_IMAGE_COUNT 2
 #define NULL 0
 
 #include "Equates.h"
@@ -32,17 +38,32 @@
 #include "Cartridge.h"
 #include "Tia.h"
 #include "Riot.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
 typedef unsigned int uint;
+typedef void (*memoryTrap)(word address, byte data);
 
 extern void memory_Reset( );
 extern byte memory_Read(word address);
 extern void memory_Write(word address, byte data);
 extern void memory_WriteROM(word address, word size, const byte* data);
 extern void memory_ClearROM(word address, word size);
+extern void memory_SetTrap(word address, uint size, memoryTrap trap);
+extern uint memory_SaveState(byte* buffer);
+extern bool memory_CheckState(const byte* buffer, uint size);
+extern bool memory_UsesImage(const byte* buffer, uint size, byte image);
+extern uint memory_LoadState(const byte* buffer, uint size);
+extern void memory_SetImage(byte image, const byte* data, uint size);
+extern void memory_SetDirty(word address);
+extern void memory_SetDirty(word address, uint size);
+extern bool memory_IsDirty(byte page, uint epoch);
+extern bool memory_IsDirty(uint epoch);
+extern uint memory_Checkpoint( );
 extern byte memory_ram[MEMORY_SIZE];
-extern byte memory_rom[MEMORY_SIZE];
+extern byte memory_rom[MEMORY_PAGE_COUNT];
+extern const byte* memory_source[MEMORY_PAGE_COUNT];
+extern uint memory_stamp[MEMORY_PAGE_COUNT];
 
 #endif
@@ -0,0 +1,166 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Mixer.cpp
+// ----------------------------------------------------------------------------
+#include <Math.h>
+#include "Mixer.h"
+#include "ProSystem.h"
+#define MIXER_PHASE_BITS 6
+#define MIXER_PHASES 64
+#define MIXER_WIDTH 16
+#define MIXER_KERNEL_BITS 12
+#define MIXER_BASS_SHIFT 9
+#define MIXER_CUTOFF 0.45
+#define MIXER_TIA_GAIN 128
+#define MIXER_POKEY_GAIN 64
+#define MIXER_PI 3.14159265358979
+
+static short mixer_kernel[MIXER_PHASES][MIXER_WIDTH];
+static bool mixer_kernelInitialized = false;
+static int mixer_buffer[MIXER_BUFFER_SIZE + MIXER_WIDTH] = {0};
+static uint mixer_sampleRate = 44100;
+static uint mixer_remainder = 0;
+static int mixer_level = 0;
+static int mixer_integrator = 0;
+
+// ----------------------------------------------------------------------------
+// InitializeKernel
+// ----------------------------------------------------------------------------
+static void mixer_InitializeKernel( ) {
+  for(int phase = 0; phase < MIXER_PHASES; phase++) {
+    double impulse[MIXER_WIDTH];
+    double sum = 0.0;
+    for(int index = 0; index < MIXER_WIDTH; index++) {
+      double x = (index - (MIXER_WIDTH / 2 - 1)) - (double)phase / MIXER_PHASES;
+      double t = x / (MIXER_WIDTH / 2);
+      double window = 0.42 + 0.5 * cos(MIXER_PI * t) + 0.08 * cos(2.0 * MIXER_PI * t);
+      double sinc = (x == 0.0)? 2.0 * MIXER_CUTOFF: sin(2.0 * MIXER_PI * MIXER_CUTOFF * x) / (MIXER_PI * x);
+      impulse[index] = (t > -1.0 && t < 1.0)? sinc * window: 0.0;
+      sum += impulse[index];
+    }
+
+    int total = 0;
+    int peak = 0;
+    for(int index = 0; index < MIXER_WIDTH; index++) {
+      double scaled = impulse[index] * (1 << MIXER_KERNEL_BITS) / sum;
+      mixer_kernel[phase][index] = (short)((scaled < 0.0)? scaled - 0.5: scaled + 0.5);
+      total += mixer_kernel[phase][index];
+      if(mixer_kernel[phase][index] > mixer_kernel[phase][peak]) {
+        peak = index;
+      }
+    }
+    mixer_kernel[phase][peak] += (1 << MIXER_KERNEL_BITS) - total;
+  }
+  mixer_kernelInitialized = true;
+}
+
+// ----------------------------------------------------------------------------
+// AddDelta
+// ----------------------------------------------------------------------------
+static void mixer_AddDelta(uint position, uint phase, int delta) {
+  const short* kernel = mixer_kernel[phase];
+  int* buffer = mixer_buffer + position;
+  for(int index = 0; index < MIXER_WIDTH; index++) {
+    buffer[index] += kernel[index] * delta;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void mixer_Reset( ) {
+  if(!mixer_kernelInitialized) {
+    mixer_InitializeKernel( );
+  }
+  for(int index = 0; index < MIXER_BUFFER_SIZE + MIXER_WIDTH; index++) {
+    mixer_buffer[index] = 0;
+  }
+  mixer_remainder = 0;
+  mixer_level = 0;
+  mixer_integrator = 0;
+}
+
+// ----------------------------------------------------------------------------
+// SetSampleRate
+// ----------------------------------------------------------------------------
+void mixer_SetSampleRate(uint rate) {
+  if(rate < MIXER_RATE_MIN) {
+    rate = MIXER_RATE_MIN;
+  }
+  else if(rate > MIXER_RATE_MAX) {
+    rate = MIXER_RATE_MAX;
+  }
+  mixer_sampleRate = rate;
+}
+
+// ----------------------------------------------------------------------------
+// GetSampleRate
+// ----------------------------------------------------------------------------
+uint mixer_GetSampleRate( ) {
+  return mixer_sampleRate;
+}
+
+// ----------------------------------------------------------------------------
+// Mix
+// ----------------------------------------------------------------------------
+uint mixer_Mix(short* target, uint size) {
+  if(!mixer_kernelInitialized) {
+    mixer_Reset( );
+  }
+
+  uint sourceRate = tia_size * prosystem_frequency;
+  for(uint index = 0; index < tia_size; index++) {
+    int level = tia_buffer[index] * MIXER_TIA_GAIN;
+    if(cartridge_pokey) {
+      level += pokey_buffer[index] * MIXER_POKEY_GAIN;
+    }
+    if(level != mixer_level) {
+      uint position = mixer_remainder + index * mixer_sampleRate;
+      mixer_AddDelta(position / sourceRate, ((position % sourceRate) << MIXER_PHASE_BITS) / sourceRate, level - mixer_level);
+      mixer_level = level;
+    }
+  }
+
+  uint total = mixer_remainder + tia_size * mixer_sampleRate;
+  uint length = total / sourceRate;
+  mixer_remainder = total % sourceRate;
+
+  int integrator = mixer_integrator;
+  for(uint index = 0; index < length; index++) {
+    int sample = integrator >> MIXER_KERNEL_BITS;
+    integrator += mixer_buffer[index];
+    integrator -= sample << (MIXER_KERNEL_BITS - MIXER_BASS_SHIFT);
+    if(index < size) {
+      target[index] = (sample > 32767)? 32767: (sample < -32768)? -32768: (short)sample;
+    }
+  }
+  mixer_integrator = integrator;
+
+  for(uint index = 0; index < MIXER_WIDTH; index++) {
+    mixer_buffer[index] = mixer_buffer[length + index];
+  }
+  for(uint index = MIXER_WIDTH; index < length + MIXER_WIDTH; index++) {
+    mixer_buffer[index] = 0;
+  }
+  return (length < size)? length: size;
+}
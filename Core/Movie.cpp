@@ -0,0 +1,533 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Movie.cpp
+// ----------------------------------------------------------------------------
+#include "Movie.h"
+#define MOVIE_HEADER "PRO-SYSTEM MOVIE"
+#define MOVIE_EXTENSIONS ".mov"
+#define MOVIE_VERSION 1
+#define MOVIE_HEADER_SIZE (16 + 1 + 32 + 4 + 4 + 4)
+#define MOVIE_INPUT_MASK 0x1ffff
+#define MOVIE_RUN_SHIFT 17
+#define MOVIE_RUN_MAX 32768
+
+byte movie_mode = MOVIE_MODE_NONE;
+
+static uint* movie_runs = NULL;
+static uint movie_runCount = 0;
+static uint movie_runCapacity = 0;
+static byte* movie_keys = NULL;
+static uint* movie_keyOffset = NULL;
+static uint movie_keyCount = 0;
+static uint movie_keyCapacity = 0;
+static uint movie_keySize = 0;
+static uint movie_keyPoolSize = 0;
+static uint movie_length = 0;
+static uint movie_frame = 0;
+static uint movie_run = 0;
+static uint movie_runFrame = 0;
+static std::string movie_digest;
+static byte movie_state[PRO_SYSTEM_STATE_SIZE];
+
+// ----------------------------------------------------------------------------
+// Pack
+// ----------------------------------------------------------------------------
+static uint movie_Pack(const byte* input) {
+  uint mask = 0;
+  for(uint index = 0; index < MOVIE_INPUT_SIZE; index++) {
+    if(input[index]) {
+      mask |= 1 << index;
+    }
+  }
+  return mask;
+}
+
+// ----------------------------------------------------------------------------
+// Unpack
+// ----------------------------------------------------------------------------
+static void movie_Unpack(uint mask, byte* input) {
+  for(uint index = 0; index < MOVIE_INPUT_SIZE; index++) {
+    input[index] = (mask >> index) & 1;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// GetRunLength
+// ----------------------------------------------------------------------------
+static uint movie_GetRunLength(uint run) {
+  return (movie_runs[run] >> MOVIE_RUN_SHIFT) + 1;
+}
+
+// ----------------------------------------------------------------------------
+// ReserveRuns
+// ----------------------------------------------------------------------------
+static bool movie_ReserveRuns(uint count) {
+  if(count <= movie_runCapacity) {
+    return true;
+  }
+  uint capacity = (movie_runCapacity == 0)? 1024: movie_runCapacity;
+  while(capacity < count) {
+    capacity <<= 1;
+  }
+  uint* runs = new uint[capacity];
+  if(runs == NULL) {
+    logger_LogError(IDS_MOVIE1,"");
+    return false;
+  }
+  for(uint index = 0; index < movie_runCount; index++) {
+    runs[index] = movie_runs[index];
+  }
+  delete [ ] movie_runs;
+  movie_runs = runs;
+  movie_runCapacity = capacity;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ReserveKeys
+// ----------------------------------------------------------------------------
+static bool movie_ReserveKeys(uint count, uint size) {
+  if(count > movie_keyCapacity) {
+    uint capacity = (movie_keyCapacity == 0)? 16: movie_keyCapacity;
+    while(capacity < count) {
+      capacity <<= 1;
+    }
+    uint* offsets = new uint[capacity + 1];
+    if(offsets == NULL) {
+      logger_LogError(IDS_MOVIE1,"");
+      return false;
+    }
+    for(uint index = 0; index <= movie_keyCount; index++) {
+      offsets[index] = (movie_keyOffset != NULL)? movie_keyOffset[index]: 0;
+    }
+    delete [ ] movie_keyOffset;
+    movie_keyOffset = offsets;
+    movie_keyCapacity = capacity;
+  }
+  if(size > movie_keyPoolSize) {
+    uint poolSize = (movie_keyPoolSize == 0)? PRO_SYSTEM_STATE_SIZE * 4: movie_keyPoolSize;
+    while(poolSize < size) {
+      poolSize <<= 1;
+    }
+    byte* keys = new byte[poolSize];
+    if(keys == NULL) {
+      logger_LogError(IDS_MOVIE1,"");
+      return false;
+    }
+    for(uint index = 0; index < movie_keySize; index++) {
+      keys[index] = movie_keys[index];
+    }
+    delete [ ] movie_keys;
+    movie_keys = keys;
+    movie_keyPoolSize = poolSize;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// AddKey
+// ----------------------------------------------------------------------------
+static bool movie_AddKey(const byte* state, uint size) {
+  if(!movie_ReserveKeys(movie_keyCount + 1, movie_keySize + size)) {
+    return false;
+  }
+  for(uint index = 0; index < size; index++) {
+    movie_keys[movie_keySize + index] = state[index];
+  }
+  movie_keySize += size;
+  movie_keyCount++;
+  movie_keyOffset[movie_keyCount] = movie_keySize;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// LoadKey
+// ----------------------------------------------------------------------------
+static bool movie_LoadKey(uint key) {
+  return prosystem_LoadState(movie_keys + movie_keyOffset[key], movie_keyOffset[key + 1] - movie_keyOffset[key]);
+}
+
+// ----------------------------------------------------------------------------
+// Locate
+// ----------------------------------------------------------------------------
+static void movie_Locate(uint frame) {
+  movie_run = 0;
+  movie_runFrame = 0;
+  movie_frame = 0;
+  while(movie_run < movie_runCount && movie_frame + movie_GetRunLength(movie_run) <= frame) {
+    movie_frame += movie_GetRunLength(movie_run);
+    movie_run++;
+  }
+  movie_runFrame = frame - movie_frame;
+  movie_frame = frame;
+}
+
+// ----------------------------------------------------------------------------
+// Clear
+// ----------------------------------------------------------------------------
+static void movie_Clear( ) {
+  movie_mode = MOVIE_MODE_NONE;
+  movie_runCount = 0;
+  movie_keyCount = 0;
+  movie_keySize = 0;
+  if(movie_keyOffset != NULL) {
+    movie_keyOffset[0] = 0;
+  }
+  movie_length = 0;
+  movie_frame = 0;
+  movie_run = 0;
+  movie_runFrame = 0;
+  movie_digest = "";
+}
+
+// ----------------------------------------------------------------------------
+// Record
+// ----------------------------------------------------------------------------
+bool movie_Record( ) {
+  if(!prosystem_active) {
+    return false;
+  }
+  movie_Clear( );
+  if(!movie_ReserveRuns(1) || !movie_ReserveKeys(1, PRO_SYSTEM_STATE_SIZE)) {
+    return false;
+  }
+  movie_keyOffset[0] = 0;
+  movie_digest = cartridge_digest;
+  movie_mode = MOVIE_MODE_RECORD;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Play
+// ----------------------------------------------------------------------------
+bool movie_Play( ) {
+  if(movie_keyCount == 0) {
+    return false;
+  }
+  if(movie_digest != cartridge_digest) {
+    logger_LogError(IDS_MOVIE6,"");
+    return false;
+  }
+  if(!movie_LoadKey(0)) {
+    return false;
+  }
+  movie_Locate(0);
+  movie_mode = MOVIE_MODE_PLAY;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Stop
+// ----------------------------------------------------------------------------
+void movie_Stop( ) {
+  movie_mode = MOVIE_MODE_NONE;
+}
+
+// ----------------------------------------------------------------------------
+// Process
+// ----------------------------------------------------------------------------
+bool movie_Process(byte* input) {
+  if(movie_mode == MOVIE_MODE_RECORD) {
+    if(movie_length % MOVIE_KEYFRAME_INTERVAL == 0) {
+      uint size = prosystem_SaveState(movie_state, PRO_SYSTEM_STATE_SIZE);
+      if(!movie_AddKey(movie_state, size)) {
+        movie_mode = MOVIE_MODE_NONE;
+        return false;
+      }
+    }
+    uint mask = movie_Pack(input);
+    if(movie_runCount != 0 && (movie_runs[movie_runCount - 1] & MOVIE_INPUT_MASK) == mask && movie_GetRunLength(movie_runCount - 1) < MOVIE_RUN_MAX) {
+      movie_runs[movie_runCount - 1] += 1 << MOVIE_RUN_SHIFT;
+    }
+    else {
+      if(!movie_ReserveRuns(movie_runCount + 1)) {
+        movie_mode = MOVIE_MODE_NONE;
+        return false;
+      }
+      movie_runs[movie_runCount++] = mask;
+    }
+    movie_length++;
+    movie_frame = movie_length;
+    return true;
+  }
+  else if(movie_mode == MOVIE_MODE_PLAY) {
+    if(movie_frame >= movie_length) {
+      movie_mode = MOVIE_MODE_NONE;
+      return false;
+    }
+    movie_Unpack(movie_runs[movie_run] & MOVIE_INPUT_MASK, input);
+    movie_runFrame++;
+    if(movie_runFrame >= movie_GetRunLength(movie_run)) {
+      movie_run++;
+      movie_runFrame = 0;
+    }
+    movie_frame++;
+    return true;
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// Seek
+// ----------------------------------------------------------------------------
+bool movie_Seek(uint frame) {
+  if(movie_mode == MOVIE_MODE_RECORD || movie_keyCount == 0 || frame > movie_length) {
+    return false;
+  }
+  uint key = frame / MOVIE_KEYFRAME_INTERVAL;
+  if(key >= movie_keyCount) {
+    key = movie_keyCount - 1;
+  }
+  if(!movie_LoadKey(key)) {
+    return false;
+  }
+  movie_Locate(key * MOVIE_KEYFRAME_INTERVAL);
+  movie_mode = MOVIE_MODE_PLAY;
+
+  byte input[MOVIE_INPUT_SIZE];
+  maria_rendering = false;
+  while(movie_frame < frame && movie_Process(input)) {
+    prosystem_ExecuteFrame(input);
+  }
+  maria_rendering = true;
+  movie_mode = (movie_frame < movie_length)? MOVIE_MODE_PLAY: MOVIE_MODE_NONE;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+uint movie_Run( ) {
+  byte input[MOVIE_INPUT_SIZE];
+  uint frames = 0;
+  maria_rendering = capture_active;
+  while(movie_Process(input)) {
+    prosystem_ExecuteFrame(input);
+    checksum_Store( );
+    prosystem_StoreCapture( );
+    frames++;
+  }
+  maria_rendering = true;
+  return frames;
+}
+
+// ----------------------------------------------------------------------------
+// Save
+// ----------------------------------------------------------------------------
+bool movie_Save(std::string filename, bool compress) {
+  if(filename.empty( ) || movie_keyCount == 0) {
+    logger_LogError(IDS_MOVIE3,filename);
+    return false;
+  }
+
+  uint size = MOVIE_HEADER_SIZE + (movie_runCount << 2) + (movie_keyCount << 2) + movie_keySize;
+  byte* buffer = new byte[size];
+  if(buffer == NULL) {
+    logger_LogError(IDS_MOVIE1,"");
+    return false;
+  }
+
+  uint offset = 0;
+  uint index;
+  state_WriteBytes(buffer, offset, (const byte*)MOVIE_HEADER, 16);
+  state_WriteByte(buffer, offset, MOVIE_VERSION);
+  for(index = 0; index < 32; index++) {
+    state_WriteByte(buffer, offset, (index < movie_digest.size( ))? movie_digest[index]: 0);
+  }
+  state_WriteUint(buffer, offset, movie_length);
+  state_WriteUint(buffer, offset, movie_runCount);
+  state_WriteUint(buffer, offset, movie_keyCount);
+  for(index = 0; index < movie_runCount; index++) {
+    state_WriteUint(buffer, offset, movie_runs[index]);
+  }
+  for(index = 0; index < movie_keyCount; index++) {
+    state_WriteUint(buffer, offset, movie_keyOffset[index + 1] - movie_keyOffset[index]);
+  }
+  state_WriteBytes(buffer, offset, movie_keys, movie_keySize);
+
+  bool result = true;
+  if(!compress) {
+    FILE* file = fopen(filename.c_str( ), "wb");
+    if(file == NULL) {
+      logger_LogError(IDS_MOVIE2,filename);
+      result = false;
+    }
+    else {
+      if(fwrite(buffer, 1, size, file) != size) {
+        logger_LogError(IDS_MOVIE3,filename);
+        result = false;
+      }
+      fclose(file);
+    }
+  }
+  else if(!archive_Compress(filename.c_str( ), "Movie.mov", buffer, size, Z_BEST_COMPRESSION)) {
+    logger_LogError(IDS_MOVIE3,filename);
+    result = false;
+  }
+  delete [ ] buffer;
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// Parse
+// ----------------------------------------------------------------------------
+static bool movie_Parse(const byte* buffer, uint size) {
+  uint offset = 0;
+  uint index;
+  if(size < MOVIE_HEADER_SIZE) {
+    return false;
+  }
+  for(index = 0; index < 16; index++) {
+    if(buffer[index] != MOVIE_HEADER[index]) {
+      return false;
+    }
+  }
+  offset = 16;
+  if(state_ReadByte(buffer, offset) != MOVIE_VERSION) {
+    return false;
+  }
+
+  char digest[33] = {0};
+  state_ReadBytes(buffer, offset, (byte*)digest, 32);
+  uint length = state_ReadUint(buffer, offset);
+  uint runCount = state_ReadUint(buffer, offset);
+  uint keyCount = state_ReadUint(buffer, offset);
+  if(keyCount == 0 || runCount > (size - offset) >> 2 || keyCount > (size - offset - (runCount << 2)) >> 2) {
+    return false;
+  }
+
+  movie_Clear( );
+  if(!movie_ReserveRuns(runCount)) {
+    return false;
+  }
+  uint total = 0;
+  for(index = 0; index < runCount; index++) {
+    movie_runs[index] = state_ReadUint(buffer, offset);
+    total += movie_GetRunLength(index);
+  }
+  movie_runCount = runCount;
+  if(total != length || (length + MOVIE_KEYFRAME_INTERVAL - 1) / MOVIE_KEYFRAME_INTERVAL != keyCount) {
+    movie_Clear( );
+    return false;
+  }
+
+  uint keys = offset + (keyCount << 2);
+  for(index = 0; index < keyCount; index++) {
+    uint keySize = state_ReadUint(buffer, offset);
+    if(keySize == 0 || keySize > PRO_SYSTEM_STATE_SIZE || keySize > size - keys || !movie_AddKey(buffer + keys, keySize)) {
+      movie_Clear( );
+      return false;
+    }
+    keys += keySize;
+  }
+  movie_length = length;
+  movie_digest = digest;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Load
+// ----------------------------------------------------------------------------
+bool movie_Load(std::string filename) {
+  if(filename.empty( )) {
+    logger_LogError(IDS_MOVIE4,filename);
+    return false;
+  }
+
+  uint size = 0;
+  uint index = 0;
+  archive* handle = archive_Open(filename);
+  FILE* file = NULL;
+  if(handle != NULL) {
+    index = archive_Find(handle, MOVIE_EXTENSIONS);
+    if(index == ARCHIVE_NONE) {
+      index = 0;
+    }
+    size = archive_GetSize(handle, index);
+  }
+  else {
+    file = fopen(filename.c_str( ), "rb");
+    if(file == NULL || fseek(file, 0, SEEK_END) || (size = ftell(file)) == 0 || fseek(file, 0, SEEK_SET)) {
+      if(file != NULL) {
+        fclose(file);
+      }
+      logger_LogError(IDS_MOVIE4,filename);
+      return false;
+    }
+  }
+
+  byte* buffer = new byte[size];
+  if(buffer == NULL) {
+    if(file != NULL) {
+      fclose(file);
+    }
+    archive_Close(handle);
+    logger_LogError(IDS_MOVIE1,"");
+    return false;
+  }
+
+  bool result = (handle != NULL)? archive_Read(handle, index, buffer, size) == size: fread(buffer, 1, size, file) == size;
+  if(file != NULL) {
+    fclose(file);
+  }
+  archive_Close(handle);
+  if(!result) {
+    logger_LogError(IDS_MOVIE4,filename);
+  }
+  else if(!movie_Parse(buffer, size)) {
+    logger_LogError(IDS_MOVIE5,"");
+    result = false;
+  }
+  delete [ ] buffer;
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// GetLength
+// ----------------------------------------------------------------------------
+uint movie_GetLength( ) {
+  return movie_length;
+}
+
+// ----------------------------------------------------------------------------
+// GetFrame
+// ----------------------------------------------------------------------------
+uint movie_GetFrame( ) {
+  return movie_frame;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void movie_Release( ) {
+  movie_Clear( );
+  delete [ ] movie_runs;
+  delete [ ] movie_keys;
+  delete [ ] movie_keyOffset;
+  movie_runs = NULL;
+  movie_keys = NULL;
+  movie_keyOffset = NULL;
+  movie_runCapacity = 0;
+  movie_keyCapacity = 0;
+  movie_keyPoolSize = 0;
+}
@@ -0,0 +1,59 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Movie.h
+// ----------------------------------------------------------------------------
+#ifndef MOVIE_H
+#define MOVIE_H
+#define MOVIE_INPUT_SIZE 17
+#define MOVIE_KEYFRAME_INTERVAL 600
+#define MOVIE_MODE_NONE 0
+#define MOVIE_MODE_RECORD 1
+#define MOVIE_MODE_PLAY 2
+#define NULL 0
+
+#include <String>
+#include <Stdio.h>
+#include "ProSystem.h"
+#include "Archive.h"
+#include "Checksum.h"
+#include "Capture.h"
+#include "Logger.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern bool movie_Record( );
+extern bool movie_Play( );
+extern void movie_Stop( );
+extern bool movie_Process(byte* input);
+extern bool movie_Seek(uint frame);
+extern uint movie_Run( );
+extern bool movie_Save(std::string filename, bool compress);
+extern bool movie_Load(std::string filename);
+extern uint movie_GetLength( );
+extern uint movie_GetFrame( );
+extern void movie_Release( );
+extern byte movie_mode;
+
+#endif
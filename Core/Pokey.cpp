@@ -38,7 +38,6 @@
 // ----------------------------------------------------------------------------
 // Pokey.cpp
 // ----------------------------------------------------------------------------
-#include <Stdlib.h>
 #include "Pokey.h"
 #define POKEY_NOTPOLY5 0x80
 #define POKEY_POLY4 0x40
@@ -67,6 +66,7 @@
 
 byte pokey_buffer[POKEY_BUFFER_SIZE] = {0};
 uint pokey_size = 524;
+bool pokey_rendering = true;
 
 static uint pokey_frequency = 1787520;
 static uint pokey_sampleRate = 31440;
@@ -78,45 +78,173 @@ static byte pokey_output[4];
 static byte pokey_outVol[4];
 static byte pokey_poly04[POKEY_POLY4_SIZE] = {1,1,0,1,1,1,0,0,0,0,1,0,1,0,0};
 static byte pokey_poly05[POKEY_POLY5_SIZE] = {0,0,1,1,0,0,0,1,1,1,1,0,0,1,0,1,0,1,1,0,1,1,1,0,1,0,0,0,0,0,1};
+static byte pokey_poly09[POKEY_POLY9_SIZE];
 static byte pokey_poly17[POKEY_POLY17_SIZE];
+static bool pokey_polyInitialized = false;
 static uint pokey_poly17Size;
-static uint pokey_polyAdjust;
 static uint pokey_poly04Cntr;
 static uint pokey_poly05Cntr;
 static uint pokey_poly17Cntr;
+static uint pokey_polyClock;
 static uint pokey_divideMax[4];
-static uint pokey_divideCount[4];
+static uint pokey_divideTime[4];
+static byte pokey_order[4];
+static uint pokey_clock;
 static uint pokey_sampleMax;
-static uint pokey_sampleCount[2];
+static uint pokey_sampleTime;
+static uint pokey_sampleFraction;
+static byte pokey_sample;
 static uint pokey_baseMultiplier;
 
+// ----------------------------------------------------------------------------
+// InitializePoly
+// ----------------------------------------------------------------------------
+static void pokey_InitializePoly(byte* poly, uint size, uint bits, uint tap) {
+  uint shift = 0;
+  for(uint index = 0; index < size; index++) {
+    uint feedback = ((shift >> (bits - 1)) ^ (shift >> (tap - 1)) ^ 1) & 1;
+    shift = ((shift << 1) | feedback) & ((1 << bits) - 1);
+    poly[index] = feedback;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// AdvancePoly
+// ----------------------------------------------------------------------------
+static uint pokey_AdvancePoly(uint counter, uint adjust, uint size) {
+  counter += adjust;
+  if(counter >= size) {
+    counter -= size;
+    if(counter >= size) {
+      counter %= size;
+    }
+  }
+  return counter;
+}
+
+// ----------------------------------------------------------------------------
+// UpdateSample
+// ----------------------------------------------------------------------------
+static void pokey_UpdateSample( ) {
+  byte currentValue = pokey_outVol[POKEY_CHANNEL1] + pokey_outVol[POKEY_CHANNEL2] + pokey_outVol[POKEY_CHANNEL3] + pokey_outVol[POKEY_CHANNEL4];
+  pokey_sample = (currentValue << 2) + 8;
+}
+
+// ----------------------------------------------------------------------------
+// SortChannel
+// ----------------------------------------------------------------------------
+static void pokey_SortChannel(byte channel) {
+  byte index = 0;
+  while(pokey_order[index] != channel) {
+    index++;
+  }
+
+  uint count = pokey_divideTime[channel] - pokey_clock;
+  while(index > 0) {
+    byte other = pokey_order[index - 1];
+    uint otherCount = pokey_divideTime[other] - pokey_clock;
+    if(otherCount < count || (otherCount == count && other > channel)) {
+      break;
+    }
+    pokey_order[index] = other;
+    index--;
+  }
+  while(index < 3) {
+    byte other = pokey_order[index + 1];
+    uint otherCount = pokey_divideTime[other] - pokey_clock;
+    if(otherCount > count || (otherCount == count && other < channel)) {
+      break;
+    }
+    pokey_order[index] = other;
+    index++;
+  }
+  pokey_order[index] = channel;
+}
+
+// ----------------------------------------------------------------------------
+// GetDivideCount
+// ----------------------------------------------------------------------------
+static uint pokey_GetDivideCount(byte channel) {
+  return pokey_divideTime[channel] - pokey_clock;
+}
+
+// ----------------------------------------------------------------------------
+// SetDivideCount
+// ----------------------------------------------------------------------------
+static void pokey_SetDivideCount(byte channel, uint count) {
+  pokey_divideTime[channel] = pokey_clock + count;
+  pokey_SortChannel(channel);
+}
+
+// ----------------------------------------------------------------------------
+// ProcessChannel
+// ----------------------------------------------------------------------------
+static void pokey_ProcessChannel(byte channel) {
+  uint adjust = pokey_clock - pokey_polyClock;
+  pokey_polyClock = pokey_clock;
+  pokey_poly04Cntr = (pokey_poly04Cntr + adjust) % POKEY_POLY4_SIZE;
+  pokey_poly05Cntr = (pokey_poly05Cntr + adjust) % POKEY_POLY5_SIZE;
+  pokey_poly17Cntr = pokey_AdvancePoly(pokey_poly17Cntr, adjust, pokey_poly17Size);
+
+  pokey_divideTime[channel] += pokey_divideMax[channel];
+  pokey_SortChannel(channel);
+
+  if((pokey_audc[channel] & POKEY_NOTPOLY5) || pokey_poly05[pokey_poly05Cntr]) {
+    if(pokey_audc[channel] & POKEY_PURE) {
+      pokey_output[channel] = !pokey_output[channel];
+    }
+    else if (pokey_audc[channel] & POKEY_POLY4) {
+      pokey_output[channel] = pokey_poly04[pokey_poly04Cntr];
+    }
+    else if(pokey_audctl & POKEY_POLY9) {
+      pokey_output[channel] = pokey_poly09[pokey_poly17Cntr];
+    }
+    else {
+      pokey_output[channel] = pokey_poly17[pokey_poly17Cntr];
+    }
+  }
+
+  if(pokey_output[channel]) {
+    pokey_outVol[channel] = pokey_audc[channel] & POKEY_VOLUME_MASK;
+  }
+  else {
+    pokey_outVol[channel] = 0;
+  }
+  pokey_UpdateSample( );
+}
+
 // ----------------------------------------------------------------------------
 // Reset
 // ----------------------------------------------------------------------------
 void pokey_Reset( ) {
-  for(int index = 0; index < POKEY_POLY17_SIZE; index++) {
-    pokey_poly17[index] = rand( ) & 1;
+  if(!pokey_polyInitialized) {
+    pokey_InitializePoly(pokey_poly09, POKEY_POLY9_SIZE, 9, 5);
+    pokey_InitializePoly(pokey_poly17, POKEY_POLY17_SIZE, 17, 14);
+    pokey_polyInitialized = true;
   }
-  pokey_polyAdjust = 0;
   pokey_poly04Cntr = 0;
   pokey_poly05Cntr = 0;
   pokey_poly17Cntr = 0;
+  pokey_polyClock = 0;
+  pokey_clock = 0;
 
   pokey_sampleMax = ((uint)pokey_frequency << 8) / pokey_sampleRate;
 
-  pokey_sampleCount[0] = 0;
-  pokey_sampleCount[1] = 0;
+  pokey_sampleTime = 0;
+  pokey_sampleFraction = 0;
 
   pokey_poly17Size = POKEY_POLY17_SIZE;
 
   for(int channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
     pokey_outVol[channel] = 0;
     pokey_output[channel] = 0;
-    pokey_divideCount[channel] = 0;
+    pokey_divideTime[channel] = 0;
     pokey_divideMax[channel] = 0x7fffffffL;
     pokey_audc[channel] = 0;
     pokey_audf[channel] = 0;
+    pokey_order[channel] = POKEY_CHANNEL4 - channel;
   }
+  pokey_UpdateSample( );
 
   pokey_audctl = 0;
   pokey_baseMultiplier = POKEY_DIV_64;
@@ -209,8 +337,8 @@ void pokey_SetRegister(word address, byte value) {
 
     if(newValue != pokey_divideMax[POKEY_CHANNEL1]) {
       pokey_divideMax[POKEY_CHANNEL1] = newValue;
-      if(pokey_divideCount[POKEY_CHANNEL1] > newValue) {
-        pokey_divideCount[POKEY_CHANNEL1] = 0;
+      if(pokey_GetDivideCount(POKEY_CHANNEL1) > newValue) {
+        pokey_SetDivideCount(POKEY_CHANNEL1, 0);
       }
     }
   }
@@ -229,8 +357,8 @@ void pokey_SetRegister(word address, byte value) {
     }
     if(newValue != pokey_divideMax[POKEY_CHANNEL2]) {
       pokey_divideMax[POKEY_CHANNEL2] = newValue;
-      if(pokey_divideCount[POKEY_CHANNEL2] > newValue) {
-        pokey_divideCount[POKEY_CHANNEL2] = newValue;
+      if(pokey_GetDivideCount(POKEY_CHANNEL2) > newValue) {
+        pokey_SetDivideCount(POKEY_CHANNEL2, newValue);
       }
     }
   }
@@ -244,8 +372,8 @@ void pokey_SetRegister(word address, byte value) {
     }
     if(newValue!= pokey_divideMax[POKEY_CHANNEL3]) {
       pokey_divideMax[POKEY_CHANNEL3] = newValue;
-      if(pokey_divideCount[POKEY_CHANNEL3] > newValue) {   
-        pokey_divideCount[POKEY_CHANNEL3] = newValue;
+      if(pokey_GetDivideCount(POKEY_CHANNEL3) > newValue) {   
+        pokey_SetDivideCount(POKEY_CHANNEL3, newValue);
       }
     }
   }
@@ -264,8 +392,8 @@ void pokey_SetRegister(word address, byte value) {
     }
     if(newValue != pokey_divideMax[POKEY_CHANNEL4]) {
       pokey_divideMax[POKEY_CHANNEL4] = newValue;
-      if(pokey_divideCount[POKEY_CHANNEL4] > newValue) {
-        pokey_divideCount[POKEY_CHANNEL4] = newValue;
+      if(pokey_GetDivideCount(POKEY_CHANNEL4) > newValue) {
+        pokey_SetDivideCount(POKEY_CHANNEL4, newValue);
       } 
     }
   }
@@ -274,84 +402,55 @@ void pokey_SetRegister(word address, byte value) {
     if(channelMask & (1 << channel)) {
       if((pokey_audc[channel] & POKEY_VOLUME_ONLY) || ((pokey_audc[channel] & POKEY_VOLUME_MASK) == 0) || (pokey_divideMax[channel] < (pokey_sampleMax >> 8))) {
         pokey_outVol[channel] = pokey_audc[channel] & POKEY_VOLUME_MASK;
-        pokey_divideCount[channel] = 0x7fffffff;
         pokey_divideMax[channel] = 0x7fffffff;
+        pokey_SetDivideCount(channel, 0x7fffffff);
       }
     }
   } 
+  pokey_UpdateSample( );
 }
 
 // ----------------------------------------------------------------------------
 // Process
 // ----------------------------------------------------------------------------
 void pokey_Process(uint length) {
-  byte* buffer = pokey_buffer + pokey_soundCntr;
-  uint* sampleCntrPtr = (uint*)((byte*)(&pokey_sampleCount[0]) + 1);
-  uint size = length;
-
   while(length) {
-    byte currentValue;
-    byte nextEvent = POKEY_SAMPLE;
-    uint eventMin = *sampleCntrPtr;
-
-    byte channel;
-    for(channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
-      if(pokey_divideCount[channel] <= eventMin) {
-        eventMin = pokey_divideCount[channel];
-        nextEvent = channel;
-      }
+    byte channel = pokey_order[0];
+    if(pokey_divideTime[channel] - pokey_clock <= pokey_sampleTime - pokey_clock) {
+      pokey_clock = pokey_divideTime[channel];
+      pokey_ProcessChannel(channel);
+      continue;
     }
-    
-    for(channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
-      pokey_divideCount[channel] -= eventMin;
-    }
-
-    *sampleCntrPtr -= eventMin;
-    pokey_polyAdjust += eventMin;
-
-    if(nextEvent != POKEY_SAMPLE) {
-      pokey_poly04Cntr = (pokey_poly04Cntr + pokey_polyAdjust) % POKEY_POLY4_SIZE;
-      pokey_poly05Cntr = (pokey_poly05Cntr + pokey_polyAdjust) % POKEY_POLY5_SIZE;
-      pokey_poly17Cntr = (pokey_poly17Cntr + pokey_polyAdjust) % pokey_poly17Size;
-      pokey_polyAdjust = 0;
-      pokey_divideCount[nextEvent] += pokey_divideMax[nextEvent];
-
-      if((pokey_audc[nextEvent] & POKEY_NOTPOLY5) || pokey_poly05[pokey_poly05Cntr]) {
-        if(pokey_audc[nextEvent] & POKEY_PURE) {
-          pokey_output[nextEvent] = !pokey_output[nextEvent];
-        }
-        else if (pokey_audc[nextEvent] & POKEY_POLY4) {
-          pokey_output[nextEvent] = pokey_poly04[pokey_poly04Cntr];
-        }
-        else {
-          pokey_output[nextEvent] = pokey_poly17[pokey_poly17Cntr];
-        }
-      }
 
-      if(pokey_output[nextEvent]) {
-        pokey_outVol[nextEvent] = pokey_audc[nextEvent] & POKEY_VOLUME_MASK;
-      }
-      else {
-        pokey_outVol[nextEvent] = 0;
-      }
+    byte* buffer = pokey_buffer + pokey_soundCntr;
+    uint count = pokey_size - pokey_soundCntr;
+    if(count > length) {
+      count = length;
     }
-    else {
-      *pokey_sampleCount += pokey_sampleMax;
-      currentValue = 0;
-
-      for(channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
-        currentValue += pokey_outVol[channel];
-      }
 
-      currentValue = (currentValue << 2) + 8;
-      *buffer++ = currentValue;
-      length--;
+    uint index = 0;
+    do {
+      pokey_clock = pokey_sampleTime;
+      pokey_sampleFraction += pokey_sampleMax;
+      pokey_sampleTime += pokey_sampleFraction >> 8;
+      pokey_sampleFraction &= 255;
+      buffer[index++] = pokey_sample;
+    } while(index < count && pokey_sampleTime - pokey_clock < pokey_divideTime[channel] - pokey_clock);
+
+    length -= index;
+    pokey_soundCntr += index;
+    if(pokey_soundCntr >= pokey_size) {
+      pokey_soundCntr = 0;
     }
-  }  
-  
-  pokey_soundCntr += size;
-  if(pokey_soundCntr >= pokey_size) {
-    pokey_soundCntr = 0;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Synchronize
+// ----------------------------------------------------------------------------
+void pokey_Synchronize(uint position) {
+  if(pokey_rendering && position > pokey_soundCntr) {
+    pokey_Process(position - pokey_soundCntr);
   }
 }
 
@@ -362,4 +461,98 @@ void pokey_Clear( ) {
   for(int index = 0; index < POKEY_BUFFER_SIZE; index++) {
     pokey_buffer[index] = 0;
   }
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint pokey_SaveState(byte* buffer) {
+  uint offset = 0;
+  for(int channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
+    state_WriteByte(buffer, offset, pokey_audf[channel]);
+    state_WriteByte(buffer, offset, pokey_audc[channel]);
+    state_WriteByte(buffer, offset, pokey_output[channel]);
+    state_WriteByte(buffer, offset, pokey_outVol[channel]);
+    state_WriteByte(buffer, offset, pokey_order[channel]);
+    state_WriteUint(buffer, offset, pokey_divideMax[channel]);
+    state_WriteUint(buffer, offset, pokey_divideTime[channel]);
+  }
+  state_WriteByte(buffer, offset, pokey_audctl);
+  state_WriteUint(buffer, offset, pokey_poly17Size);
+  state_WriteUint(buffer, offset, pokey_poly04Cntr);
+  state_WriteUint(buffer, offset, pokey_poly05Cntr);
+  state_WriteUint(buffer, offset, pokey_poly17Cntr);
+  state_WriteUint(buffer, offset, pokey_polyClock);
+  state_WriteUint(buffer, offset, pokey_clock);
+  state_WriteUint(buffer, offset, pokey_sampleMax);
+  state_WriteUint(buffer, offset, pokey_sampleTime);
+  state_WriteUint(buffer, offset, pokey_sampleFraction);
+  state_WriteByte(buffer, offset, pokey_sample);
+  state_WriteUint(buffer, offset, pokey_baseMultiplier);
+  state_WriteUint(buffer, offset, pokey_soundCntr);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// CheckState
+// ----------------------------------------------------------------------------
+bool pokey_CheckState(const byte* buffer) {
+  uint offset = 0;
+  byte orders = 0;
+  for(int channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
+    offset += 4;
+    byte order = state_ReadByte(buffer, offset);
+    if(order > POKEY_CHANNEL4) {
+      return false;
+    }
+    orders |= 1 << order;
+    offset += 8;
+  }
+  if(orders != 15) {
+    return false;
+  }
+
+  byte audctl = state_ReadByte(buffer, offset);
+  uint poly17Size = state_ReadUint(buffer, offset);
+  uint poly04Cntr = state_ReadUint(buffer, offset);
+  uint poly05Cntr = state_ReadUint(buffer, offset);
+  uint poly17Cntr = state_ReadUint(buffer, offset);
+  if(poly17Size != ((audctl & POKEY_POLY9)? POKEY_POLY9_SIZE: POKEY_POLY17_SIZE)) {
+    return false;
+  }
+  if(poly04Cntr >= POKEY_POLY4_SIZE || poly05Cntr >= POKEY_POLY5_SIZE || poly17Cntr >= poly17Size) {
+    return false;
+  }
+  offset += 25;
+  return state_ReadUint(buffer, offset) < pokey_size;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint pokey_LoadState(const byte* buffer) {
+  uint offset = 0;
+  for(int channel = POKEY_CHANNEL1; channel <= POKEY_CHANNEL4; channel++) {
+    pokey_audf[channel] = state_ReadByte(buffer, offset);
+    pokey_audc[channel] = state_ReadByte(buffer, offset);
+    pokey_output[channel] = state_ReadByte(buffer, offset);
+    pokey_outVol[channel] = state_ReadByte(buffer, offset);
+    pokey_order[channel] = state_ReadByte(buffer, offset);
+    pokey_divideMax[channel] = state_ReadUint(buffer, offset);
+    pokey_divideTime[channel] = state_ReadUint(buffer, offset);
+  }
+  pokey_audctl = state_ReadByte(buffer, offset);
+  pokey_poly17Size = state_ReadUint(buffer, offset);
+  pokey_poly04Cntr = state_ReadUint(buffer, offset);
+  pokey_poly05Cntr = state_ReadUint(buffer, offset);
+  pokey_poly17Cntr = state_ReadUint(buffer, offset);
+  pokey_polyClock = state_ReadUint(buffer, offset);
+  pokey_clock = state_ReadUint(buffer, offset);
+  pokey_sampleMax = state_ReadUint(buffer, offset);
+  pokey_sampleTime = state_ReadUint(buffer, offset);
+  pokey_sampleFraction = state_ReadUint(buffer, offset);
+  pokey_sample = state_ReadByte(buffer, offset);
+  pokey_baseMultiplier = state_ReadUint(buffer, offset);
+  pokey_soundCntr = state_ReadUint(buffer, offset);
+  return offset;
+}
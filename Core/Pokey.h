@@ -40,6 +40,7 @@
 // ----------------------------------------------------------------------------
 #ifndef POKEY_H
 #define POKEY_H
+#define POKEY_STATE_SIZE 98
 #define POKEY_BUFFER_SIZE 624
 #define POKEY_AUDF1 0x4000
 #define POKEY_AUDC1 0x4001
@@ -51,6 +52,8 @@
 #define POKEY_AUDC4 0x4007
 #define POKEY_AUDCTL 0x4008
 
+#include "State.h"
+
 typedef unsigned char byte;
 typedef unsigned short word;
 typedef unsigned int uint;
@@ -58,8 +61,13 @@ typedef unsigned int uint;
 extern void pokey_Reset( );
 extern void pokey_SetRegister(word address, byte value);
 extern void pokey_Process(uint length);
+extern void pokey_Synchronize(uint position);
 extern void pokey_Clear( );
+extern uint pokey_SaveState(byte* buffer);
+extern bool pokey_CheckState(const byte* buffer);
+extern uint pokey_LoadState(const byte* buffer);
 extern byte pokey_buffer[POKEY_BUFFER_SIZE];
 extern uint pokey_size;
+extern bool pokey_rendering;
 
 #endif
@@ -24,6 +24,12 @@
 // ----------------------------------------------------------------------------
 #include "ProSystem.h"
 #define PRO_SYSTEM_STATE_HEADER "PRO-SYSTEM STATE"
+#define PRO_SYSTEM_STATE_EXTENSIONS ".sav"
+#define PRO_SYSTEM_STATE_VERSION 3
+#define PRO_SYSTEM_STATE_VERSION_FULL 2
+#define PRO_SYSTEM_INPUT_SIZE 17
+#define PRO_SYSTEM_CAPTURE_TIA_GAIN 128
+#define PRO_SYSTEM_CAPTURE_POKEY_GAIN 64
 
 bool prosystem_active = false;
 bool prosystem_paused = false;
@@ -32,6 +38,16 @@ byte prosystem_frame = 0;
 word prosystem_scanlines = 262;
 uint prosystem_cycles = 0;
 
+static byte prosystem_state[PRO_SYSTEM_STATE_SIZE];
+static machine* prosystem_present = NULL;
+static machine* prosystem_future = NULL;
+static bool prosystem_futureHandoff = false;
+static byte prosystem_futureInput[PRO_SYSTEM_INPUT_SIZE];
+static byte prosystem_futureTia[TIA_BUFFER_SIZE];
+static byte prosystem_futurePokey[POKEY_BUFFER_SIZE];
+static byte prosystem_tiaBuffer[TIA_BUFFER_SIZE];
+static byte prosystem_pokeyBuffer[POKEY_BUFFER_SIZE];
+
 // ----------------------------------------------------------------------------
 // Reset
 // ----------------------------------------------------------------------------
@@ -45,6 +61,7 @@ void prosystem_Reset( ) {
     pokey_Clear( );
     pokey_Reset( );
     memory_Reset( );
+    cartridge_Install( );
     maria_Clear( );
     maria_Reset( );
 	riot_Reset ( );
@@ -67,9 +84,11 @@ void prosystem_ExecuteFrame(const byte* input) {
   
   for(maria_scanline = 1; maria_scanline <= prosystem_scanlines; maria_scanline++) {
     if(maria_scanline == maria_displayArea.top) {
+      memory_SetDirty(MSTAT);
       memory_ram[MSTAT] = 0;
     }
     if(maria_scanline == maria_displayArea.bottom) {
+      memory_SetDirty(MSTAT);
       memory_ram[MSTAT] = 128;
     }
     
@@ -83,6 +102,7 @@ void prosystem_ExecuteFrame(const byte* input) {
       }
       if(memory_ram[WSYNC] && !(cartridge_flags & CARTRIDGE_WSYNC_MASK)) {
         prosystem_cycles = 456;
+        memory_SetDirty(WSYNC);
         memory_ram[WSYNC] = false;
         break;
       }
@@ -101,14 +121,15 @@ void prosystem_ExecuteFrame(const byte* input) {
       }
       if(memory_ram[WSYNC] && !(cartridge_flags & CARTRIDGE_WSYNC_MASK)) {
         prosystem_cycles = 456;
+        memory_SetDirty(WSYNC);
         memory_ram[WSYNC] = false;
         break;
       }
     }
-    tia_Process(2);
-    if(cartridge_pokey) {
-      pokey_Process(2);
-    }
+  }
+  tia_Synchronize(prosystem_scanlines << 1);
+  if(cartridge_pokey) {
+    pokey_Synchronize(prosystem_scanlines << 1);
   }
   prosystem_frame++;
   if(prosystem_frame >= prosystem_frequency) {
@@ -117,81 +138,274 @@ void prosystem_ExecuteFrame(const byte* input) {
 }
 
 // ----------------------------------------------------------------------------
-// Save
+// Copy
 // ----------------------------------------------------------------------------
-bool prosystem_Save(std::string filename, bool compress) {
-  if(filename.empty( ) || filename.length( ) == 0) {
-    logger_LogError(IDS_PROSYSTEM1,"");
-    return false;
+static void prosystem_Copy(byte* target, const byte* source, uint size) {
+  for(uint index = 0; index < size; index++) {
+    target[index] = source[index];
+  }
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseForks
+// ----------------------------------------------------------------------------
+static void prosystem_ReleaseForks( ) {
+  machine_Release(prosystem_present);
+  machine_Release(prosystem_future);
+  prosystem_present = NULL;
+  prosystem_future = NULL;
+}
+
+// ----------------------------------------------------------------------------
+// RunAhead
+// ----------------------------------------------------------------------------
+void prosystem_RunAhead(const byte* input, byte frames) {
+  if(frames > PRO_SYSTEM_RUN_AHEAD_MAX) {
+    frames = PRO_SYSTEM_RUN_AHEAD_MAX;
+  }
+  if(frames == 0) {
+    prosystem_ExecuteFrame(input);
+    return;
   }
 
-  logger_LogInfo(IDS_PROSYSTEM2,filename);
-  
-  byte buffer[32829] = {0};
-  uint size = 0;
-  
   uint index;
-  for(index = 0; index < 16; index++) {
-    buffer[size + index] = PRO_SYSTEM_STATE_HEADER[index];
+  bool predicted = prosystem_future != NULL && machine_IsCurrent(prosystem_present);
+  for(index = 0; index < PRO_SYSTEM_INPUT_SIZE && predicted; index++) {
+    predicted = (input[index] == prosystem_futureInput[index]);
   }
-  size += 16;
-  
-  buffer[size++] = 1;
-  for(index = 0; index < 4; index++) {
-    buffer[size + index] = 0;
+  if(predicted) {
+    machine_Load(prosystem_future);
+    bios_handoff = prosystem_futureHandoff;
+    prosystem_Copy(tia_buffer, prosystem_futureTia, tia_size);
+    prosystem_Copy(pokey_buffer, prosystem_futurePokey, pokey_size);
+  }
+  else {
+    maria_rendering = false;
+    prosystem_ExecuteFrame(input);
+    maria_rendering = true;
+  }
+  prosystem_ReleaseForks( );
+  prosystem_present = machine_Fork( );
+  if(prosystem_present == NULL) {
+    return;
   }
-  size += 4;
+  bool handoff = bios_handoff;
+  prosystem_Copy(prosystem_tiaBuffer, tia_buffer, tia_size);
+  prosystem_Copy(prosystem_pokeyBuffer, pokey_buffer, pokey_size);
 
-  for(index = 0; index < 32; index++) {
-    buffer[size + index] = cartridge_digest[index];
+  maria_rendering = (frames == 1);
+  prosystem_ExecuteFrame(input);
+  prosystem_future = machine_Fork( );
+  prosystem_futureHandoff = bios_handoff;
+  for(index = 0; index < PRO_SYSTEM_INPUT_SIZE; index++) {
+    prosystem_futureInput[index] = input[index];
   }
-  size += 32;
+  prosystem_Copy(prosystem_futureTia, tia_buffer, tia_size);
+  prosystem_Copy(prosystem_futurePokey, pokey_buffer, pokey_size);
 
-  buffer[size++] = sally_a;
-  buffer[size++] = sally_x;
-  buffer[size++] = sally_y;
-  buffer[size++] = sally_p;
-  buffer[size++] = sally_s;
-  buffer[size++] = sally_pc.b.l;
-  buffer[size++] = sally_pc.b.h;
-  buffer[size++] = cartridge_bank;
+  tia_rendering = false;
+  pokey_rendering = false;
+  for(byte frame = 2; frame <= frames; frame++) {
+    maria_rendering = (frame == frames);
+    prosystem_ExecuteFrame(input);
+  }
+  maria_rendering = true;
+  tia_rendering = true;
+  pokey_rendering = true;
 
-  for(index = 0; index < 16384; index++) {
-    buffer[size + index] = memory_ram[index];
+  machine_Load(prosystem_present);
+  bios_handoff = handoff;
+  prosystem_Copy(tia_buffer, prosystem_tiaBuffer, tia_size);
+  prosystem_Copy(pokey_buffer, prosystem_pokeyBuffer, pokey_size);
+}
+
+// ----------------------------------------------------------------------------
+// GetSoundPosition
+// ----------------------------------------------------------------------------
+uint prosystem_GetSoundPosition( ) {
+  uint cycles = (prosystem_cycles < 456)? prosystem_cycles: 455;
+  return ((maria_scanline - 1) << 1) + (cycles / 228);
+}
+
+// ----------------------------------------------------------------------------
+// WriteChunk
+// ----------------------------------------------------------------------------
+static void prosystem_WriteChunk(byte* buffer, uint& offset, const char* id, uint size) {
+  state_WriteBytes(buffer, offset, (const byte*)id, 4);
+  state_WriteUint(buffer, offset, size);
+}
+
+// ----------------------------------------------------------------------------
+// LocateChunk
+// ----------------------------------------------------------------------------
+static const byte* prosystem_LocateChunk(const byte* buffer, uint size, const char* id, uint& length) {
+  uint offset = 17;
+  while(offset + PRO_SYSTEM_STATE_CHUNK_SIZE <= size) {
+    const byte* chunk = buffer + offset;
+    offset += 4;
+    length = state_ReadUint(buffer, offset);
+    if(length > size - offset) {
+      return NULL;
+    }
+    if(chunk[0] == id[0] && chunk[1] == id[1] && chunk[2] == id[2] && chunk[3] == id[3]) {
+      return buffer + offset;
+    }
+    offset += length;
   }
-  size += 16384;
-  
-  if(cartridge_type == CARTRIDGE_TYPE_SUPERCART_RAM) {
-    for(index = 0; index < 16384; index++) {
-      buffer[size + index] = memory_ram[16384 + index];
-    } 
-    size += 16384;
+  return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// FindChunk
+// ----------------------------------------------------------------------------
+static const byte* prosystem_FindChunk(const byte* buffer, uint size, const char* id, uint chunkSize) {
+  uint length = 0;
+  const byte* chunk = prosystem_LocateChunk(buffer, size, id, length);
+  return (length == chunkSize)? chunk: NULL;
+}
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint prosystem_SaveState(byte* buffer, uint size) {
+  if(buffer == NULL || size < PRO_SYSTEM_STATE_SIZE) {
+    return 0;
   }
-  
-  if(!compress) {
-    FILE* file = fopen(filename.c_str( ), "wb");
-    if(file == NULL) {
-      logger_LogError(IDS_PROSYSTEM3,filename);
-      return false;
-    }
-  
-    if(fwrite(buffer, 1, size, file) != size) {
-      fclose(file);
-      logger_LogError(IDS_PROSYSTEM4,filename);
+
+  uint offset = 0;
+  state_WriteBytes(buffer, offset, (const byte*)PRO_SYSTEM_STATE_HEADER, 16);
+  state_WriteByte(buffer, offset, PRO_SYSTEM_STATE_VERSION);
+
+  uint index;
+  prosystem_WriteChunk(buffer, offset, "DGST", 32);
+  for(index = 0; index < 32; index++) {
+    state_WriteByte(buffer, offset, (index < cartridge_digest.length( ))? cartridge_digest[index]: 0);
+  }
+  prosystem_WriteChunk(buffer, offset, "BIOS", 32);
+  for(index = 0; index < 32; index++) {
+    state_WriteByte(buffer, offset, (index < bios_digest.length( ))? bios_digest[index]: 0);
+  }
+
+  prosystem_WriteChunk(buffer, offset, "SYS ", 5);
+  state_WriteByte(buffer, offset, prosystem_frame);
+  state_WriteUint(buffer, offset, prosystem_cycles);
+
+  prosystem_WriteChunk(buffer, offset, "CPU ", SALLY_STATE_SIZE);
+  offset += sally_SaveState(buffer + offset);
+  prosystem_WriteChunk(buffer, offset, "CART", CARTRIDGE_STATE_SIZE);
+  offset += cartridge_SaveState(buffer + offset);
+  uint length = offset + 4;
+  prosystem_WriteChunk(buffer, offset, "MEM ", 0);
+  uint memory = memory_SaveState(buffer + offset);
+  state_WriteUint(buffer, length, memory);
+  offset += memory;
+  prosystem_WriteChunk(buffer, offset, "MARI", MARIA_STATE_SIZE);
+  offset += maria_SaveState(buffer + offset);
+  prosystem_WriteChunk(buffer, offset, "RIOT", RIOT_STATE_SIZE);
+  offset += riot_SaveState(buffer + offset);
+  prosystem_WriteChunk(buffer, offset, "TIA ", TIA_STATE_SIZE);
+  offset += tia_SaveState(buffer + offset);
+  prosystem_WriteChunk(buffer, offset, "POKY", POKEY_STATE_SIZE);
+  offset += pokey_SaveState(buffer + offset);
+  prosystem_WriteChunk(buffer, offset, "END ", 0);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+bool prosystem_LoadState(const byte* buffer, uint size) {
+  if(buffer == NULL || size < 17 || !cartridge_IsLoaded( )) {
+    return false;
+  }
+  for(uint index = 0; index < 16; index++) {
+    if(buffer[index] != PRO_SYSTEM_STATE_HEADER[index]) {
+      logger_LogError(IDS_PROSYSTEM13,"");
       return false;
     }
-  
-    fclose(file);
   }
-  else {
-    if(!archive_Compress(filename.c_str( ), "Save.sav", buffer, size)) {
-      logger_LogError(IDS_PROSYSTEM5, filename);
+  if(buffer[16] != PRO_SYSTEM_STATE_VERSION && buffer[16] != PRO_SYSTEM_STATE_VERSION_FULL) {
+    logger_LogError(IDS_PROSYSTEM13,"");
+    return false;
+  }
+
+  const byte* digest = prosystem_FindChunk(buffer, size, "DGST", 32);
+  const byte* system = prosystem_FindChunk(buffer, size, "SYS ", 5);
+  const byte* sally = prosystem_FindChunk(buffer, size, "CPU ", SALLY_STATE_SIZE);
+  const byte* cartridge = prosystem_FindChunk(buffer, size, "CART", CARTRIDGE_STATE_SIZE);
+  uint memorySize = 0;
+  const byte* memory = prosystem_LocateChunk(buffer, size, "MEM ", memorySize);
+  const byte* maria = prosystem_FindChunk(buffer, size, "MARI", MARIA_STATE_SIZE);
+  const byte* riot = prosystem_FindChunk(buffer, size, "RIOT", RIOT_STATE_SIZE);
+  const byte* tia = prosystem_FindChunk(buffer, size, "TIA ", TIA_STATE_SIZE);
+  const byte* pokey = prosystem_FindChunk(buffer, size, "POKY", POKEY_STATE_SIZE);
+  if(memory != NULL && !memory_CheckState(memory, memorySize)) {
+    memory = NULL;
+  }
+  if(digest == NULL || system == NULL || sally == NULL || cartridge == NULL || memory == NULL || maria == NULL || riot == NULL || tia == NULL || pokey == NULL) {
+    logger_LogError(IDS_PROSYSTEM13,"");
+    return false;
+  }
+
+  char value[33] = {0};
+  for(uint index = 0; index < 32; index++) {
+    value[index] = digest[index];
+  }
+  if(cartridge_digest != std::string(value)) {
+    logger_LogError(IDS_PROSYSTEM14, "[" + std::string(value) + "] [" + cartridge_digest + "].");
+    return false;
+  }
+  if(memory_UsesImage(memory, memorySize, MEMORY_IMAGE_BIOS)) {
+    const byte* bios = prosystem_FindChunk(buffer, size, "BIOS", 32);
+    for(uint index = 0; index < 32; index++) {
+      value[index] = (bios != NULL)? bios[index]: 0;
+    }
+    if(!bios_IsLoaded( ) || bios_digest != std::string(value)) {
+      logger_LogError(IDS_PROSYSTEM16, "[" + std::string(value) + "] [" + bios_digest + "].");
       return false;
     }
   }
+  if(!tia_CheckState(tia) || !pokey_CheckState(pokey)) {
+    logger_LogError(IDS_PROSYSTEM12,"");
+    return false;
+  }
+
+  uint offset = 0;
+  prosystem_frame = state_ReadByte(system, offset);
+  prosystem_cycles = state_ReadUint(system, offset);
+  sally_LoadState(sally);
+  cartridge_LoadState(cartridge);
+  memory_LoadState(memory, memorySize);
+  maria_LoadState(maria);
+  riot_LoadState(riot);
+  tia_LoadState(tia);
+  pokey_LoadState(pokey);
+  prosystem_active = true;
   return true;
 }
 
+// ----------------------------------------------------------------------------
+// Save
+// ----------------------------------------------------------------------------
+bool prosystem_Save(std::string filename, bool compress) {
+  if(filename.empty( ) || filename.length( ) == 0) {
+    logger_LogError(IDS_PROSYSTEM1,"");
+    return false;
+  }
+
+  logger_LogInfo(IDS_PROSYSTEM2,filename);
+  
+  uint size = prosystem_SaveState(prosystem_state, PRO_SYSTEM_STATE_SIZE);
+  return writer_Write(filename, "Save.sav", prosystem_state, size, compress);
+}
+
+// ----------------------------------------------------------------------------
+// IsStateSize
+// ----------------------------------------------------------------------------
+static bool prosystem_IsStateSize(uint size) {
+  return size == 16445 || size == 32829 || (size > 16 && size <= PRO_SYSTEM_STATE_SIZE);
+}
+
 // ----------------------------------------------------------------------------
 // Load
 // ----------------------------------------------------------------------------
@@ -203,10 +417,12 @@ bool prosystem_Load(const std::string filename) {
 
  
   logger_LogInfo(IDS_PROSYSTEM6,filename);
+  writer_Wait( );
   
-  byte buffer[32829] = {0};
-  uint size = archive_GetUncompressedFileSize(filename);
-  if(size == 0) {
+  byte* buffer = prosystem_state;
+  uint size = 0;
+  archive* handle = archive_Open(filename);
+  if(handle == NULL) {
     FILE* file = fopen(filename.c_str( ), "rb");
     if(file == NULL) {
       logger_LogError(IDS_PROSYSTEM7,filename);
@@ -226,7 +442,7 @@ bool prosystem_Load(const std::string filename) {
       return false;
     }
 
-    if(size != 16445 && size != 32829) {
+    if(!prosystem_IsStateSize(size)) {
       fclose(file);
       logger_LogError(IDS_PROSYSTEM10,"");
       return false;
@@ -239,11 +455,26 @@ bool prosystem_Load(const std::string filename) {
     }
     fclose(file);
   }  
-  else if(size == 16445 || size == 32829) {
-    archive_Uncompress(filename, buffer, size);
-  }
   else {
-    logger_LogError(IDS_PROSYSTEM12,"");
+    uint index = archive_Find(handle, PRO_SYSTEM_STATE_EXTENSIONS);
+    if(index == ARCHIVE_NONE) {
+      index = 0;
+    }
+    size = archive_GetSize(handle, index);
+    if(!prosystem_IsStateSize(size)) {
+      archive_Close(handle);
+      logger_LogError(IDS_PROSYSTEM12,"");
+      return false;
+    }
+    size = archive_Read(handle, index, buffer, size);
+    archive_Close(handle);
+  }
+
+  if(buffer[16] == PRO_SYSTEM_STATE_VERSION || buffer[16] == PRO_SYSTEM_STATE_VERSION_FULL) {
+    return prosystem_LoadState(buffer, size);
+  }
+  if(size != 16445 && size != 32829) {
+    logger_LogError(IDS_PROSYSTEM10,"");
     return false;
   }
 
@@ -285,6 +516,7 @@ bool prosystem_Load(const std::string filename) {
   
   cartridge_StoreBank(buffer[offset++]);
 
+  memory_SetDirty(0, 16384);
   for(index = 0; index < 16384; index++) {
     memory_ram[index] = buffer[offset + index];
   }
@@ -295,6 +527,7 @@ bool prosystem_Load(const std::string filename) {
       logger_LogError(IDS_PROSYSTEM15,"");
       return false;
     }
+    memory_SetDirty(16384, 16384);
     for(index = 0; index < 16384; index++) {
       memory_ram[16384 + index] = buffer[offset + index];
     }
@@ -313,10 +546,45 @@ void prosystem_Pause(bool pause) {
   }
 }
 
+// ----------------------------------------------------------------------------
+// OpenCapture
+// ----------------------------------------------------------------------------
+bool prosystem_OpenCapture(std::string videoFilename, std::string audioFilename, bool background) {
+  if(!prosystem_active) {
+    logger_LogError(IDS_CAPTURE1,videoFilename);
+    return false;
+  }
+  return capture_Open(videoFilename, audioFilename, maria_visibleArea.GetLength( ), maria_visibleArea.GetHeight( ), prosystem_frequency, tia_size * prosystem_frequency, background);
+}
+
+// ----------------------------------------------------------------------------
+// StoreCapture
+// ----------------------------------------------------------------------------
+bool prosystem_StoreCapture( ) {
+  if(!capture_active) {
+    return false;
+  }
+  uint area = maria_visibleArea.GetLength( ) * maria_visibleArea.GetHeight( );
+  uint offset = (maria_visibleArea.top - maria_displayArea.top) * maria_visibleArea.GetLength( );
+  if(offset + area > MARIA_SURFACE_SIZE) {
+    offset = MARIA_SURFACE_SIZE - area;
+  }
+  short samples[TIA_BUFFER_SIZE];
+  for(uint index = 0; index < tia_size; index++) {
+    int level = tia_buffer[index] * PRO_SYSTEM_CAPTURE_TIA_GAIN;
+    if(cartridge_pokey) {
+      level += pokey_buffer[index] * PRO_SYSTEM_CAPTURE_POKEY_GAIN;
+    }
+    samples[index] = (short)level;
+  }
+  return capture_Store(maria_surface + offset, palette_data, samples, tia_size);
+}
+
 // ----------------------------------------------------------------------------
 // Close
 // ----------------------------------------------------------------------------
 void prosystem_Close( ) {
+  prosystem_ReleaseForks( );
   prosystem_active = false;
   prosystem_paused = false;
   cartridge_Release( );
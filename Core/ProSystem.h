@@ -24,6 +24,9 @@
 // ----------------------------------------------------------------------------
 #ifndef PRO_SYSTEM_H
 #define PRO_SYSTEM_H
+#define PRO_SYSTEM_STATE_CHUNK_SIZE 8
+#define PRO_SYSTEM_RUN_AHEAD_MAX 4
+#define PRO_SYSTEM_STATE_SIZE (17 + (11 * PRO_SYSTEM_STATE_CHUNK_SIZE) + 32 + 32 + 5 + SALLY_STATE_SIZE + CARTRIDGE_STATE_SIZE + MEMORY_STATE_SIZE + MARIA_STATE_SIZE + RIOT_STATE_SIZE + TIA_STATE_SIZE + POKEY_STATE_SIZE)
 #define NULL 0
 
 #include <String>
@@ -37,8 +40,12 @@
 #include "Riot.h"
 #include "Sally.h"
 #include "Archive.h"
+#include "Writer.h"
 #include "Tia.h"
 #include "Pokey.h"
+#include "State.h"
+#include "Machine.h"
+#include "Capture.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -46,9 +53,15 @@ typedef unsigned int uint;
 
 extern void prosystem_Reset( );
 extern void prosystem_ExecuteFrame(const byte* input);
+extern void prosystem_RunAhead(const byte* input, byte frames);
+extern uint prosystem_GetSoundPosition( );
+extern uint prosystem_SaveState(byte* buffer, uint size);
+extern bool prosystem_LoadState(const byte* buffer, uint size);
 extern bool prosystem_Save(std::string filename, bool compress);
 extern bool prosystem_Load(std::string filename);
 extern void prosystem_Pause(bool pause);
+extern bool prosystem_OpenCapture(std::string videoFilename, std::string audioFilename, bool background);
+extern bool prosystem_StoreCapture( );
 extern void prosystem_Close( );
 extern bool prosystem_active;
 extern bool prosystem_paused;
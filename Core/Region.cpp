@@ -175,11 +175,21 @@ static const byte REGION_PALETTE_PAL[ ] = {
   0xd6,0xe1,0x49,0xe4,0xf0,0x4e,0xf2,0xff,0x53,0xf2,0xff,0x53,
 };
 
+// ----------------------------------------------------------------------------
+// GetActual
+// ----------------------------------------------------------------------------
+byte region_GetActual( ) {
+  if(region_type == REGION_PAL || (region_type == REGION_AUTO && cartridge_region == REGION_PAL)) {
+    return REGION_PAL;
+  }
+  return REGION_NTSC;
+}
+
 // ----------------------------------------------------------------------------
 // Reset
 // ----------------------------------------------------------------------------
 void region_Reset( ) {
-  if(region_type == REGION_PAL || (region_type == REGION_AUTO && cartridge_region == REGION_PAL)) {
+  if(region_GetActual( ) == REGION_PAL) {
     maria_displayArea = REGION_DISPLAY_AREA_PAL;
     maria_visibleArea = REGION_VISIBLE_AREA_PAL;
 	if(palette_default)
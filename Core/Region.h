@@ -39,6 +39,7 @@ typedef unsigned short word;
 typedef unsigned int uint;
 
 extern void region_Reset( );
+extern byte region_GetActual( );
 extern byte region_type;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Rewind.cpp
+// ----------------------------------------------------------------------------
+#include "Rewind.h"
+#define REWIND_ENTRY_MASK (REWIND_ENTRY_SIZE - 1)
+#define REWIND_PACK_SIZE (PRO_SYSTEM_STATE_SIZE + (PRO_SYSTEM_STATE_SIZE >> 7) + 1)
+
+static byte* rewind_arena = NULL;
+static uint rewind_arenaSize = 0;
+static uint rewind_position = 0;
+static uint rewind_offset[REWIND_ENTRY_SIZE];
+static uint rewind_length[REWIND_ENTRY_SIZE];
+static uint rewind_key[REWIND_ENTRY_SIZE];
+static uint rewind_first = 0;
+static uint rewind_next = 0;
+static byte rewind_state[PRO_SYSTEM_STATE_SIZE];
+static byte rewind_keyState[PRO_SYSTEM_STATE_SIZE];
+static uint rewind_keySize = 0;
+static uint rewind_keyEntry = 0;
+static bool rewind_keyValid = false;
+
+// ----------------------------------------------------------------------------
+// Pack
+// ----------------------------------------------------------------------------
+static uint rewind_Pack(const byte* source, uint size, byte* target) {
+  uint length = 0;
+  uint index = 0;
+  while(index < size) {
+    uint run = 1;
+    if(source[index] == 0) {
+      while(run < 128 && index + run < size && source[index + run] == 0) {
+        run++;
+      }
+      target[length++] = 127 + run;
+    }
+    else {
+      while(run < 128 && index + run < size && (source[index + run] != 0 || (index + run + 1 < size && source[index + run + 1] != 0))) {
+        run++;
+      }
+      target[length++] = run - 1;
+      for(uint literal = 0; literal < run; literal++) {
+        target[length++] = source[index + literal];
+      }
+    }
+    index += run;
+  }
+  return length;
+}
+
+// ----------------------------------------------------------------------------
+// Unpack
+// ----------------------------------------------------------------------------
+static uint rewind_Unpack(const byte* source, uint length, byte* target) {
+  uint index = 0;
+  uint position = 0;
+  while(position < length) {
+    byte control = source[position++];
+    if(control & 128) {
+      for(uint run = 0; run < control - 127u; run++) {
+        target[index++] = 0;
+      }
+    }
+    else {
+      for(uint run = 0; run <= control; run++) {
+        target[index++] = source[position++];
+      }
+    }
+  }
+  return index;
+}
+
+// ----------------------------------------------------------------------------
+// Evict
+// ----------------------------------------------------------------------------
+static void rewind_Evict( ) {
+  rewind_first++;
+  while(rewind_first != rewind_next && rewind_key[rewind_first & REWIND_ENTRY_MASK] != rewind_first) {
+    rewind_first++;
+  }
+  if(rewind_keyValid && (int)(rewind_keyEntry - rewind_first) < 0) {
+    rewind_keyValid = false;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Reserve
+// ----------------------------------------------------------------------------
+static void rewind_Reserve( ) {
+  if(rewind_next - rewind_first >= REWIND_ENTRY_SIZE) {
+    rewind_Evict( );
+  }
+  if(rewind_position + REWIND_PACK_SIZE > rewind_arenaSize) {
+    while(rewind_first != rewind_next && rewind_offset[rewind_first & REWIND_ENTRY_MASK] >= rewind_position) {
+      rewind_Evict( );
+    }
+    rewind_position = 0;
+  }
+  while(rewind_first != rewind_next) {
+    uint index = rewind_first & REWIND_ENTRY_MASK;
+    if(rewind_offset[index] >= rewind_position + REWIND_PACK_SIZE || rewind_offset[index] + rewind_length[index] <= rewind_position) {
+      break;
+    }
+    rewind_Evict( );
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Decode
+// ----------------------------------------------------------------------------
+static uint rewind_Decode(uint entry, byte* target) {
+  uint index = entry & REWIND_ENTRY_MASK;
+  return rewind_Unpack(rewind_arena + rewind_offset[index], rewind_length[index], target);
+}
+
+// ----------------------------------------------------------------------------
+// SetKey
+// ----------------------------------------------------------------------------
+static void rewind_SetKey(uint size) {
+  for(uint index = size; index < rewind_keySize; index++) {
+    rewind_keyState[index] = 0;
+  }
+  rewind_keySize = size;
+}
+
+// ----------------------------------------------------------------------------
+// Initialize
+// ----------------------------------------------------------------------------
+bool rewind_Initialize(uint size) {
+  rewind_Release( );
+  if(size < REWIND_PACK_SIZE * 2) {
+    size = REWIND_PACK_SIZE * 2;
+  }
+  rewind_arena = new byte[size];
+  if(rewind_arena == NULL) {
+    logger_LogError(IDS_REWIND1,"");
+    return false;
+  }
+  rewind_arenaSize = size;
+  rewind_Reset( );
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+void rewind_Reset( ) {
+  rewind_position = 0;
+  rewind_first = 0;
+  rewind_next = 0;
+  rewind_keyValid = false;
+}
+
+// ----------------------------------------------------------------------------
+// Store
+// ----------------------------------------------------------------------------
+bool rewind_Store( ) {
+  if(rewind_arena == NULL) {
+    return false;
+  }
+
+  rewind_Reserve( );
+  uint size = prosystem_SaveState(rewind_state, PRO_SYSTEM_STATE_SIZE);
+  bool keyframe = !rewind_keyValid || rewind_next - rewind_keyEntry >= REWIND_KEYFRAME_INTERVAL;
+  uint index;
+  if(keyframe) {
+    for(index = 0; index < size; index++) {
+      rewind_keyState[index] = rewind_state[index];
+    }
+    rewind_SetKey(size);
+  }
+  else {
+    for(index = size; index < rewind_keySize; index++) {
+      rewind_state[index] = 0;
+    }
+    if(size < rewind_keySize) {
+      size = rewind_keySize;
+    }
+    for(index = 0; index < size; index++) {
+      rewind_state[index] ^= rewind_keyState[index];
+    }
+  }
+
+  uint entry = rewind_next & REWIND_ENTRY_MASK;
+  rewind_offset[entry] = rewind_position;
+  rewind_length[entry] = rewind_Pack(rewind_state, size, rewind_arena + rewind_position);
+  if(keyframe) {
+    rewind_keyEntry = rewind_next;
+    rewind_keyValid = true;
+  }
+  rewind_key[entry] = rewind_keyEntry;
+  rewind_position += rewind_length[entry];
+  rewind_next++;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Step
+// ----------------------------------------------------------------------------
+bool rewind_Step( ) {
+  if(rewind_arena == NULL || rewind_next - rewind_first < 2) {
+    return false;
+  }
+
+  rewind_next--;
+  rewind_position = rewind_offset[rewind_next & REWIND_ENTRY_MASK];
+  uint entry = rewind_next - 1;
+  uint key = rewind_key[entry & REWIND_ENTRY_MASK];
+  if(!rewind_keyValid || rewind_keyEntry != key) {
+    rewind_SetKey(rewind_Decode(key, rewind_keyState));
+    rewind_keyEntry = key;
+    rewind_keyValid = true;
+  }
+  if(entry == key) {
+    return prosystem_LoadState(rewind_keyState, rewind_keySize);
+  }
+
+  uint size = rewind_Decode(entry, rewind_state);
+  for(uint index = 0; index < size; index++) {
+    rewind_state[index] ^= rewind_keyState[index];
+  }
+  return prosystem_LoadState(rewind_state, size);
+}
+
+// ----------------------------------------------------------------------------
+// GetCount
+// ----------------------------------------------------------------------------
+uint rewind_GetCount( ) {
+  return rewind_next - rewind_first;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void rewind_Release( ) {
+  if(rewind_arena != NULL) {
+    delete [ ] rewind_arena;
+    rewind_arena = NULL;
+    rewind_arenaSize = 0;
+  }
+  rewind_Reset( );
+}
@@ -0,0 +1,46 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// Rewind.h
+// ----------------------------------------------------------------------------
+#ifndef REWIND_H
+#define REWIND_H
+#define REWIND_ARENA_SIZE 67108864
+#define REWIND_ENTRY_SIZE 32768
+#define REWIND_KEYFRAME_INTERVAL 60
+#define NULL 0
+
+#include "ProSystem.h"
+#include "Logger.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern bool rewind_Initialize(uint size);
+extern void rewind_Reset( );
+extern bool rewind_Store( );
+extern bool rewind_Step( );
+extern uint rewind_GetCount( );
+extern void rewind_Release( );
+
+#endif
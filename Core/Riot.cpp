@@ -59,6 +59,8 @@ void riot_Reset(void) {
 // | 16       | Console      | Right Difficulty
 // +----------+--------------+-------------------------------------------------
 void riot_SetInput(const byte* input) {
+  memory_SetDirty(SWCHA);
+  memory_SetDirty(INPT0);
   (input[0x00])? memory_ram[SWCHA] = memory_ram[SWCHA] &~ 0x80: memory_ram[SWCHA] = memory_ram[SWCHA] | 0x80;
   (input[0x01])? memory_ram[SWCHA] = memory_ram[SWCHA] &~ 0x40: memory_ram[SWCHA] = memory_ram[SWCHA] | 0x40;
   (input[0x02])? memory_ram[SWCHA] = memory_ram[SWCHA] &~ 0x20: memory_ram[SWCHA] = memory_ram[SWCHA] | 0x20;
@@ -157,8 +159,37 @@ void riot_UpdateTimer(byte cycles) {
     else {
       riot_currentTime = riot_clocks;
       memory_Write(INTIM, 0);
+	  memory_SetDirty(INTFLG);
 	  memory_ram[INTFLG] |= 0x80;
       riot_elapsed = true;
     }
   }
 }
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint riot_SaveState(byte* buffer) {
+  uint offset = 0;
+  state_WriteByte(buffer, offset, riot_timing);
+  state_WriteWord(buffer, offset, riot_timer);
+  state_WriteByte(buffer, offset, riot_intervals);
+  state_WriteByte(buffer, offset, riot_elapsed);
+  state_WriteUint(buffer, offset, riot_currentTime);
+  state_WriteWord(buffer, offset, riot_clocks);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint riot_LoadState(const byte* buffer) {
+  uint offset = 0;
+  riot_timing = state_ReadByte(buffer, offset) != 0;
+  riot_timer = state_ReadWord(buffer, offset);
+  riot_intervals = state_ReadByte(buffer, offset);
+  riot_elapsed = state_ReadByte(buffer, offset) != 0;
+  riot_currentTime = state_ReadUint(buffer, offset);
+  riot_clocks = state_ReadWord(buffer, offset);
+  return offset;
+}
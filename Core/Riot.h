@@ -24,9 +24,11 @@
 // ----------------------------------------------------------------------------
 #ifndef RIOT_H
 #define RIOT_H
+#define RIOT_STATE_SIZE 11
 
 #include "Equates.h"
 #include "Memory.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -36,6 +38,8 @@ extern void riot_Reset(void);
 extern void riot_SetInput(const byte* input);
 extern void riot_SetTimer(word timer, byte intervals);
 extern void riot_UpdateTimer(byte cycles);
+extern uint riot_SaveState(byte* buffer);
+extern uint riot_LoadState(const byte* buffer);
 extern bool riot_timing;
 extern word riot_timer;
 extern byte riot_intervals;
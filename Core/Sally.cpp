@@ -1734,3 +1734,31 @@ uint sally_ExecuteIRQ( ) {
   }
   return 7;
 }
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint sally_SaveState(byte* buffer) {
+  uint offset = 0;
+  state_WriteByte(buffer, offset, sally_a);
+  state_WriteByte(buffer, offset, sally_x);
+  state_WriteByte(buffer, offset, sally_y);
+  state_WriteByte(buffer, offset, sally_p);
+  state_WriteByte(buffer, offset, sally_s);
+  state_WriteWord(buffer, offset, sally_pc.w);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint sally_LoadState(const byte* buffer) {
+  uint offset = 0;
+  sally_a = state_ReadByte(buffer, offset);
+  sally_x = state_ReadByte(buffer, offset);
+  sally_y = state_ReadByte(buffer, offset);
+  sally_p = state_ReadByte(buffer, offset);
+  sally_s = state_ReadByte(buffer, offset);
+  sally_pc.w = state_ReadWord(buffer, offset);
+  return offset;
+}
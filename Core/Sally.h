@@ -24,9 +24,11 @@
 // ----------------------------------------------------------------------------
 #ifndef SALLY_H
 #define SALLY_H
+#define SALLY_STATE_SIZE 7
 
 #include "Memory.h"
 #include "Pair.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -37,6 +39,8 @@ extern uint sally_ExecuteInstruction( );
 extern uint sally_ExecuteRES( );
 extern uint sally_ExecuteNMI( );
 extern uint sally_ExecuteIRQ( );
+extern uint sally_SaveState(byte* buffer);
+extern uint sally_LoadState(const byte* buffer);
 extern byte sally_a;
 extern byte sally_x;
 extern byte sally_y;
@@ -0,0 +1,92 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// State.cpp
+// ----------------------------------------------------------------------------
+#include <String.h>
+#include "State.h"
+
+// ----------------------------------------------------------------------------
+// WriteByte
+// ----------------------------------------------------------------------------
+void state_WriteByte(byte* buffer, uint& offset, byte data) {
+  buffer[offset++] = data;
+}
+
+// ----------------------------------------------------------------------------
+// WriteWord
+// ----------------------------------------------------------------------------
+void state_WriteWord(byte* buffer, uint& offset, word data) {
+  buffer[offset++] = data & 255;
+  buffer[offset++] = data >> 8;
+}
+
+// ----------------------------------------------------------------------------
+// WriteUint
+// ----------------------------------------------------------------------------
+void state_WriteUint(byte* buffer, uint& offset, uint data) {
+  buffer[offset++] = data & 255;
+  buffer[offset++] = (data >> 8) & 255;
+  buffer[offset++] = (data >> 16) & 255;
+  buffer[offset++] = data >> 24;
+}
+
+// ----------------------------------------------------------------------------
+// WriteBytes
+// ----------------------------------------------------------------------------
+void state_WriteBytes(byte* buffer, uint& offset, const byte* data, uint size) {
+  memcpy(buffer + offset, data, size);
+  offset += size;
+}
+
+// ----------------------------------------------------------------------------
+// ReadByte
+// ----------------------------------------------------------------------------
+byte state_ReadByte(const byte* buffer, uint& offset) {
+  return buffer[offset++];
+}
+
+// ----------------------------------------------------------------------------
+// ReadWord
+// ----------------------------------------------------------------------------
+word state_ReadWord(const byte* buffer, uint& offset) {
+  word data = buffer[offset] | (buffer[offset + 1] << 8);
+  offset += 2;
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// ReadUint
+// ----------------------------------------------------------------------------
+uint state_ReadUint(const byte* buffer, uint& offset) {
+  uint data = buffer[offset] | (buffer[offset + 1] << 8) | (buffer[offset + 2] << 16) | ((uint)buffer[offset + 3] << 24);
+  offset += 4;
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// ReadBytes
+// ----------------------------------------------------------------------------
+void state_ReadBytes(const byte* buffer, uint& offset, byte* data, uint size) {
+  memcpy(data, buffer + offset, size);
+  offset += size;
+}
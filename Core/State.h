@@ -0,0 +1,41 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// State.h
+// ----------------------------------------------------------------------------
+#ifndef STATE_H
+#define STATE_H
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern void state_WriteByte(byte* buffer, uint& offset, byte data);
+extern void state_WriteWord(byte* buffer, uint& offset, word data);
+extern void state_WriteUint(byte* buffer, uint& offset, uint data);
+extern void state_WriteBytes(byte* buffer, uint& offset, const byte* data, uint size);
+extern byte state_ReadByte(const byte* buffer, uint& offset);
+extern word state_ReadWord(const byte* buffer, uint& offset);
+extern uint state_ReadUint(const byte* buffer, uint& offset);
+extern void state_ReadBytes(const byte* buffer, uint& offset, byte* data, uint size);
+
+#endif
@@ -0,0 +1,244 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Thread.cpp
+// ----------------------------------------------------------------------------
+#include "Thread.h"
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+struct Thread {
+  threadRoutine routine;
+#if defined(_WIN32)
+  HANDLE handle;
+#else
+  pthread_t handle;
+  pthread_mutex_t mutex;
+  bool done;
+#endif
+};
+
+struct ThreadEvent {
+#if defined(_WIN32)
+  HANDLE handle;
+#else
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+  bool signaled;
+#endif
+};
+
+#if defined(_WIN32)
+// ----------------------------------------------------------------------------
+// Start
+// ----------------------------------------------------------------------------
+static DWORD WINAPI thread_Start(LPVOID parameter) {
+  ((thread*)parameter)->routine( );
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Create
+// ----------------------------------------------------------------------------
+thread* thread_Create(threadRoutine routine) {
+  thread* handle = new thread;
+  if(handle == NULL) {
+    return NULL;
+  }
+  handle->routine = routine;
+  DWORD threadId;
+  handle->handle = CreateThread(NULL, 0, thread_Start, handle, 0, &threadId);
+  if(handle->handle == NULL) {
+    delete handle;
+    return NULL;
+  }
+  return handle;
+}
+
+// ----------------------------------------------------------------------------
+// IsDone
+// ----------------------------------------------------------------------------
+bool thread_IsDone(thread* handle) {
+  return WaitForSingleObject(handle->handle, 0) == WAIT_OBJECT_0;
+}
+
+// ----------------------------------------------------------------------------
+// Join
+// ----------------------------------------------------------------------------
+void thread_Join(thread* handle) {
+  WaitForSingleObject(handle->handle, INFINITE);
+  CloseHandle(handle->handle);
+  delete handle;
+}
+
+// ----------------------------------------------------------------------------
+// CreateEvent
+// ----------------------------------------------------------------------------
+threadEvent* thread_CreateEvent( ) {
+  threadEvent* event = new threadEvent;
+  if(event == NULL) {
+    return NULL;
+  }
+  event->handle = CreateEvent(NULL, FALSE, FALSE, NULL);
+  if(event->handle == NULL) {
+    delete event;
+    return NULL;
+  }
+  return event;
+}
+
+// ----------------------------------------------------------------------------
+// Signal
+// ----------------------------------------------------------------------------
+void thread_Signal(threadEvent* event) {
+  SetEvent(event->handle);
+}
+
+// ----------------------------------------------------------------------------
+// Wait
+// ----------------------------------------------------------------------------
+void thread_Wait(threadEvent* event) {
+  WaitForSingleObject(event->handle, INFINITE);
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseEvent
+// ----------------------------------------------------------------------------
+void thread_ReleaseEvent(threadEvent* event) {
+  CloseHandle(event->handle);
+  delete event;
+}
+
+// ----------------------------------------------------------------------------
+// Barrier
+// ----------------------------------------------------------------------------
+void thread_Barrier( ) {
+  static long barrier = 0;
+  InterlockedExchange(&barrier, 0);
+}
+#else
+// ----------------------------------------------------------------------------
+// Start
+// ----------------------------------------------------------------------------
+static void* thread_Start(void* parameter) {
+  thread* handle = (thread*)parameter;
+  handle->routine( );
+  pthread_mutex_lock(&handle->mutex);
+  handle->done = true;
+  pthread_mutex_unlock(&handle->mutex);
+  return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// Create
+// ----------------------------------------------------------------------------
+thread* thread_Create(threadRoutine routine) {
+  thread* handle = new thread;
+  if(handle == NULL) {
+    return NULL;
+  }
+  handle->routine = routine;
+  handle->done = false;
+  pthread_mutex_init(&handle->mutex, NULL);
+  if(pthread_create(&handle->handle, NULL, thread_Start, handle) != 0) {
+    pthread_mutex_destroy(&handle->mutex);
+    delete handle;
+    return NULL;
+  }
+  return handle;
+}
+
+// ----------------------------------------------------------------------------
+// IsDone
+// ----------------------------------------------------------------------------
+bool thread_IsDone(thread* handle) {
+  pthread_mutex_lock(&handle->mutex);
+  bool done = handle->done;
+  pthread_mutex_unlock(&handle->mutex);
+  return done;
+}
+
+// ----------------------------------------------------------------------------
+// Join
+// ----------------------------------------------------------------------------
+void thread_Join(thread* handle) {
+  pthread_join(handle->handle, NULL);
+  pthread_mutex_destroy(&handle->mutex);
+  delete handle;
+}
+
+// ----------------------------------------------------------------------------
+// CreateEvent
+// ----------------------------------------------------------------------------
+threadEvent* thread_CreateEvent( ) {
+  threadEvent* event = new threadEvent;
+  if(event == NULL) {
+    return NULL;
+  }
+  event->signaled = false;
+  pthread_mutex_init(&event->mutex, NULL);
+  pthread_cond_init(&event->condition, NULL);
+  return event;
+}
+
+// ----------------------------------------------------------------------------
+// Signal
+// ----------------------------------------------------------------------------
+void thread_Signal(threadEvent* event) {
+  pthread_mutex_lock(&event->mutex);
+  event->signaled = true;
+  pthread_cond_signal(&event->condition);
+  pthread_mutex_unlock(&event->mutex);
+}
+
+// ----------------------------------------------------------------------------
+// Wait
+// ----------------------------------------------------------------------------
+void thread_Wait(threadEvent* event) {
+  pthread_mutex_lock(&event->mutex);
+  while(!event->signaled) {
+    pthread_cond_wait(&event->condition, &event->mutex);
+  }
+  event->signaled = false;
+  pthread_mutex_unlock(&event->mutex);
+}
+
+// ----------------------------------------------------------------------------
+// ReleaseEvent
+// ----------------------------------------------------------------------------
+void thread_ReleaseEvent(threadEvent* event) {
+  pthread_cond_destroy(&event->condition);
+  pthread_mutex_destroy(&event->mutex);
+  delete event;
+}
+
+// ----------------------------------------------------------------------------
+// Barrier
+// ----------------------------------------------------------------------------
+void thread_Barrier( ) {
+  __sync_synchronize( );
+}
+#endif
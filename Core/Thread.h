@@ -0,0 +1,49 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Thread.h
+// ----------------------------------------------------------------------------
+#ifndef THREAD_H
+#define THREAD_H
+#define NULL 0
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+typedef void (*threadRoutine)( );
+
+struct Thread;
+typedef Thread thread;
+struct ThreadEvent;
+typedef ThreadEvent threadEvent;
+
+extern thread* thread_Create(threadRoutine routine);
+extern bool thread_IsDone(thread* handle);
+extern void thread_Join(thread* handle);
+extern threadEvent* thread_CreateEvent( );
+extern void thread_Signal(threadEvent* event);
+extern void thread_Wait(threadEvent* event);
+extern void thread_ReleaseEvent(threadEvent* event);
+extern void thread_Barrier( );
+
+#endif
@@ -42,9 +42,11 @@
 #define TIA_POLY4_SIZE 15
 #define TIA_POLY5_SIZE 31
 #define TIA_POLY9_SIZE 511
+#define TIA_COUNTER_MAX 96
 
 byte tia_buffer[TIA_BUFFER_SIZE] = {0};
 uint tia_size = 524;
+bool tia_rendering = true;
 
 static const byte TIA_POLY4[ ] = {1,1,0,1,1,1,0,0,0,0,1,0,1,0,0};
 static const byte TIA_POLY5[ ] = {0,0,1,0,1,1,0,0,1,1,1,1,1,0,0,0,1,1,0,1,1,1,0,1,0,1,0,0,0,0,1};
@@ -183,24 +185,122 @@ void tia_SetRegister(word address, byte data) {
 // Process
 // --------------------------------------------------------------------------------------
 void tia_Process(uint length) {
-  for(uint index = 0; index < length; index++) {
-    if(tia_counter[0] > 1) {
-      tia_counter[0]--;
+  while(length) {
+    uint run = length;
+    for(byte channel = 0; channel < 2; channel++) {
+      if(tia_counter[channel] && tia_counter[channel] - 1u < run) {
+        run = tia_counter[channel] - 1;
+      }
     }
-    else if(tia_counter[0] == 1) {
-      tia_counter[0] = tia_counterMax[0];
-      tia_ProcessChannel(0);
+
+    if(run == 0) {
+      for(byte channel = 0; channel < 2; channel++) {
+        if(tia_counter[channel] > 1) {
+          tia_counter[channel]--;
+        }
+        else if(tia_counter[channel] == 1) {
+          tia_counter[channel] = tia_counterMax[channel];
+          tia_ProcessChannel(channel);
+        }
+      }
+      run = 1;
     }
-    if(tia_counter[1] > 1) {
-      tia_counter[1]--;
+    else {
+      for(byte channel = 0; channel < 2; channel++) {
+        if(tia_counter[channel] > 1) {
+          tia_counter[channel] -= run;
+        }
+      }
     }
-    else if(tia_counter[1] == 1) {
-      tia_counter[1] = tia_counterMax[1];
-      tia_ProcessChannel(1);
+    length -= run;
+
+    byte sample = tia_volume[0] + tia_volume[1];
+    while(run) {
+      uint count = tia_size - tia_soundCntr;
+      if(count > run) {
+        count = run;
+      }
+      byte* buffer = tia_buffer + tia_soundCntr;
+      for(uint index = 0; index < count; index++) {
+        buffer[index] = sample;
+      }
+      tia_soundCntr += count;
+      if(tia_soundCntr >= tia_size) {
+        tia_soundCntr = 0;
+      }
+      run -= count;
     }
-    tia_buffer[tia_soundCntr++] = tia_volume[0] + tia_volume[1];
-    if(tia_soundCntr >= tia_size) {
-      tia_soundCntr = 0;
+  }
+}
+
+// --------------------------------------------------------------------------------------
+// Synchronize
+// --------------------------------------------------------------------------------------
+void tia_Synchronize(uint position) {
+  if(tia_rendering && position > tia_soundCntr) {
+    tia_Process(position - tia_soundCntr);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// SaveState
+// ----------------------------------------------------------------------------
+uint tia_SaveState(byte* buffer) {
+  uint offset = 0;
+  for(int index = 0; index < 2; index++) {
+    state_WriteByte(buffer, offset, tia_volume[index]);
+    state_WriteByte(buffer, offset, tia_counterMax[index]);
+    state_WriteByte(buffer, offset, tia_counter[index]);
+    state_WriteByte(buffer, offset, tia_audc[index]);
+    state_WriteByte(buffer, offset, tia_audf[index]);
+    state_WriteByte(buffer, offset, tia_audv[index]);
+    state_WriteUint(buffer, offset, tia_poly4Cntr[index]);
+    state_WriteUint(buffer, offset, tia_poly5Cntr[index]);
+    state_WriteUint(buffer, offset, tia_poly9Cntr[index]);
+  }
+  state_WriteUint(buffer, offset, tia_soundCntr);
+  return offset;
+}
+
+// ----------------------------------------------------------------------------
+// CheckState
+// ----------------------------------------------------------------------------
+bool tia_CheckState(const byte* buffer) {
+  uint offset = 0;
+  for(int index = 0; index < 2; index++) {
+    offset++;
+    byte counterMax = state_ReadByte(buffer, offset);
+    byte counter = state_ReadByte(buffer, offset);
+    offset += 3;
+    uint poly4Cntr = state_ReadUint(buffer, offset);
+    uint poly5Cntr = state_ReadUint(buffer, offset);
+    uint poly9Cntr = state_ReadUint(buffer, offset);
+    if(counterMax > TIA_COUNTER_MAX || counter > TIA_COUNTER_MAX) {
+      return false;
+    }
+    if(poly4Cntr >= TIA_POLY4_SIZE || poly5Cntr >= TIA_POLY5_SIZE || poly9Cntr >= TIA_POLY9_SIZE) {
+      return false;
     }
   }
-}
\ No newline at end of file
+  return state_ReadUint(buffer, offset) < tia_size;
+}
+
+// ----------------------------------------------------------------------------
+// LoadState
+// ----------------------------------------------------------------------------
+uint tia_LoadState(const byte* buffer) {
+  uint offset = 0;
+  for(int index = 0; index < 2; index++) {
+    tia_volume[index] = state_ReadByte(buffer, offset);
+    tia_counterMax[index] = state_ReadByte(buffer, offset);
+    tia_counter[index] = state_ReadByte(buffer, offset);
+    tia_audc[index] = state_ReadByte(buffer, offset);
+    tia_audf[index] = state_ReadByte(buffer, offset);
+    tia_audv[index] = state_ReadByte(buffer, offset);
+    tia_poly4Cntr[index] = state_ReadUint(buffer, offset);
+    tia_poly5Cntr[index] = state_ReadUint(buffer, offset);
+    tia_poly9Cntr[index] = state_ReadUint(buffer, offset);
+  }
+  tia_soundCntr = state_ReadUint(buffer, offset);
+  return offset;
+}
@@ -40,9 +40,11 @@
 // ----------------------------------------------------------------------------
 #ifndef TIA_H
 #define TIA_H
+#define TIA_STATE_SIZE 40
 #define TIA_BUFFER_SIZE 624
 
 #include "Equates.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -52,7 +54,12 @@ extern void tia_Reset( );
 extern void tia_SetRegister(word address, byte data);
 extern void tia_Clear( );
 extern void tia_Process(uint length);
+extern void tia_Synchronize(uint position);
+extern uint tia_SaveState(byte* buffer);
+extern bool tia_CheckState(const byte* buffer);
+extern uint tia_LoadState(const byte* buffer);
 extern byte tia_buffer[TIA_BUFFER_SIZE];
+extern bool tia_rendering;
 extern uint tia_size;
 
 #endif
\ No newline at end of file
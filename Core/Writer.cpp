@@ -0,0 +1,148 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Writer.cpp
+// ----------------------------------------------------------------------------
+#include "Writer.h"
+
+static thread* writer_thread = NULL;
+static byte* writer_buffer = NULL;
+static uint writer_capacity = 0;
+static uint writer_size = 0;
+static std::string writer_filename;
+static std::string writer_entry;
+static bool writer_compress = false;
+static int writer_error = 0;
+
+// ----------------------------------------------------------------------------
+// Flush
+// ----------------------------------------------------------------------------
+static int writer_Flush( ) {
+  if(writer_compress) {
+    return archive_Deflate(writer_filename, writer_entry, writer_buffer, writer_size, WRITER_LEVEL);
+  }
+
+  FILE* file = fopen(writer_filename.c_str( ), "wb");
+  if(file == NULL) {
+    return IDS_WRITER1;
+  }
+  if(fwrite(writer_buffer, 1, writer_size, file) != writer_size) {
+    fclose(file);
+    return IDS_WRITER2;
+  }
+  fclose(file);
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+static void writer_Run( ) {
+  writer_error = writer_Flush( );
+}
+
+// ----------------------------------------------------------------------------
+// Finish
+// ----------------------------------------------------------------------------
+static byte writer_Finish( ) {
+  thread_Join(writer_thread);
+  writer_thread = NULL;
+  if(writer_error != 0) {
+    logger_LogError(writer_error, writer_filename);
+    return WRITER_FAILED;
+  }
+  return WRITER_DONE;
+}
+
+// ----------------------------------------------------------------------------
+// Write
+// ----------------------------------------------------------------------------
+bool writer_Write(std::string filename, std::string entry, const byte* data, uint size, bool compress) {
+  if(filename.empty( ) || data == NULL) {
+    logger_LogError(IDS_WRITER1,filename);
+    return false;
+  }
+  writer_Wait( );
+
+  if(size > writer_capacity) {
+    delete [ ] writer_buffer;
+    writer_buffer = new byte[size];
+    if(writer_buffer == NULL) {
+      writer_capacity = 0;
+      logger_LogError(IDS_WRITER1,filename);
+      return false;
+    }
+    writer_capacity = size;
+  }
+  for(uint index = 0; index < size; index++) {
+    writer_buffer[index] = data[index];
+  }
+  writer_size = size;
+  writer_filename = filename;
+  writer_entry = entry;
+  writer_compress = compress;
+  writer_error = 0;
+
+  writer_thread = thread_Create(writer_Run);
+  if(writer_thread == NULL) {
+    writer_error = writer_Flush( );
+    if(writer_error != 0) {
+      logger_LogError(writer_error, filename);
+      return false;
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Poll
+// ----------------------------------------------------------------------------
+byte writer_Poll( ) {
+  if(writer_thread == NULL) {
+    return WRITER_IDLE;
+  }
+  if(!thread_IsDone(writer_thread)) {
+    return WRITER_BUSY;
+  }
+  return writer_Finish( );
+}
+
+// ----------------------------------------------------------------------------
+// Wait
+// ----------------------------------------------------------------------------
+bool writer_Wait( ) {
+  if(writer_thread == NULL) {
+    return true;
+  }
+  return writer_Finish( ) == WRITER_DONE;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void writer_Release( ) {
+  writer_Wait( );
+  delete [ ] writer_buffer;
+  writer_buffer = NULL;
+  writer_capacity = 0;
+}
@@ -0,0 +1,50 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Writer.h
+// ----------------------------------------------------------------------------
+#ifndef WRITER_H
+#define WRITER_H
+#define WRITER_IDLE 0
+#define WRITER_BUSY 1
+#define WRITER_DONE 2
+#define WRITER_FAILED 3
+#define WRITER_LEVEL Z_BEST_SPEED
+#define NULL 0
+
+#include <String>
+#include <Stdio.h>
+#include "Archive.h"
+#include "Thread.h"
+#include "Logger.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern bool writer_Write(std::string filename, std::string entry, const byte* data, uint size, bool compress);
+extern byte writer_Poll( );
+extern bool writer_Wait( );
+extern void writer_Release( );
+
+#endif
@@ -101,6 +101,14 @@ SOURCE=.\Core\Archive.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Audio.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Audio.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Bios.cpp
 # End Source File
 # Begin Source File
@@ -109,6 +117,30 @@ SOURCE=.\Core\Bios.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Blitter.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Blitter.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Boot.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Boot.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Capture.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Capture.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Cartridge.cpp
 # End Source File
 # Begin Source File
@@ -117,6 +149,14 @@ SOURCE=.\Core\Cartridge.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Checksum.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Checksum.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Equates.h
 # End Source File
 # Begin Source File
@@ -129,6 +169,14 @@ SOURCE=.\Core\Hash.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Image.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Image.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Logger.cpp
 # End Source File
 # Begin Source File
@@ -137,6 +185,14 @@ SOURCE=.\Core\Logger.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Machine.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Machine.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Maria.cpp
 # End Source File
 # Begin Source File
@@ -153,6 +209,22 @@ SOURCE=.\Core\Memory.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Mixer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Mixer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Movie.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Movie.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Pair.h
 # End Source File
 # Begin Source File
@@ -193,6 +265,14 @@ SOURCE=.\Core\Region.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\Rewind.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Rewind.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Riot.cpp
 # End Source File
 # Begin Source File
@@ -209,12 +289,36 @@ SOURCE=.\Core\Sally.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Core\State.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\State.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Thread.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Thread.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Core\Tia.cpp
 # End Source File
 # Begin Source File
 
 SOURCE=.\Core\Tia.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\Core\Writer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Core\Writer.h
+# End Source File
 # End Group
 # Begin Group "Win"
 
@@ -229,6 +333,14 @@ SOURCE=.\Win\About.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Win\Batch.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Win\Batch.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Win\Common.cpp
 # End Source File
 # Begin Source File
@@ -285,6 +397,14 @@ SOURCE=.\Win\Input.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Win\Library.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Win\Library.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Win\Main.cpp
 # End Source File
 # Begin Source File
@@ -0,0 +1,103 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// BlitterBenchmark.cpp
+// ----------------------------------------------------------------------------
+// Times blitting a full 320x223 frame of random palette indices into 16, 24
+// and 32-bit targets at each level the processor supports, and checks that
+// every level produces the same frame.
+// ----------------------------------------------------------------------------
+#include "Blitter.h"
+#include <Stdio.h>
+#include <Stdlib.h>
+#include <String.h>
+#include <Time.h>
+
+#define BENCHMARK_WIDTH 320
+#define BENCHMARK_HEIGHT 223
+#define BENCHMARK_FRAMES 2000
+
+typedef void (*benchmarkBlit)(byte* target, uint pitch, const byte* source, uint length, uint height);
+
+static word benchmark_palette16[256];
+static uint benchmark_palette32[256];
+static byte benchmark_source[BENCHMARK_WIDTH * BENCHMARK_HEIGHT];
+static byte benchmark_target[BENCHMARK_WIDTH * BENCHMARK_HEIGHT * 4];
+static byte benchmark_scalar[BENCHMARK_WIDTH * BENCHMARK_HEIGHT * 4];
+static uint benchmark_seed = 1;
+static const char* BENCHMARK_LEVELS[ ] = {"scalar", "sse2", "avx2"};
+
+// ----------------------------------------------------------------------------
+// Random
+// ----------------------------------------------------------------------------
+static uint benchmark_Random( ) {
+  benchmark_seed = benchmark_seed * 1103515245 + 12345;
+  return benchmark_seed >> 16;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+static double benchmark_Run(benchmarkBlit blit, uint depth) {
+  clock_t start = clock( );
+  for(uint frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    blit(benchmark_target, BENCHMARK_WIDTH * depth, benchmark_source, BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+  }
+  return ((double)(clock( ) - start) / CLOCKS_PER_SEC) * 1000000.0 / BENCHMARK_FRAMES;
+}
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+int main( ) {
+  for(uint index = 0; index < 256; index++) {
+    benchmark_palette16[index] = (word)benchmark_Random( );
+    benchmark_palette32[index] = (benchmark_Random( ) << 16) ^ benchmark_Random( );
+  }
+  for(uint index = 0; index < BENCHMARK_WIDTH * BENCHMARK_HEIGHT; index++) {
+    benchmark_source[index] = (byte)benchmark_Random( );
+  }
+  blitter_SetPalette16(benchmark_palette16);
+  blitter_SetPalette32(benchmark_palette32);
+
+  benchmarkBlit blits[3] = {blitter_Blit16, blitter_Blit24, blitter_Blit32};
+  for(uint format = 0; format < 3; format++) {
+    uint depth = format + 2;
+    uint size = BENCHMARK_WIDTH * BENCHMARK_HEIGHT * depth;
+    printf("Blitter: %u-bit", depth << 3);
+    for(byte level = BLITTER_LEVEL_SCALAR; level <= blitter_GetSupportedLevel( ); level++) {
+      blitter_SetLevel(level);
+      double elapsed = benchmark_Run(blits[format], depth);
+      if(level == BLITTER_LEVEL_SCALAR) {
+        memcpy(benchmark_scalar, benchmark_target, size);
+      }
+      else if(memcmp(benchmark_scalar, benchmark_target, size) != 0) {
+        printf("\nBlitter: %u-bit %s frame differs from scalar\n", depth << 3, BENCHMARK_LEVELS[level]);
+        return 1;
+      }
+      printf(" %s %.1f us", BENCHMARK_LEVELS[level], elapsed);
+    }
+    printf(" per frame\n");
+  }
+  return 0;
+}
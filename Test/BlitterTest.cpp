@@ -0,0 +1,125 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// BlitterTest.cpp
+// ----------------------------------------------------------------------------
+// Blits random rows of every length up to a little past a frame width at each
+// level the processor supports and compares the output byte for byte with a
+// direct palette lookup. The target rows are padded and the padding has to
+// come back untouched, so kernels that store past the end of a row fail too.
+// ----------------------------------------------------------------------------
+#include "Blitter.h"
+#include <Stdio.h>
+#include <Stdlib.h>
+#include <String.h>
+
+#define TEST_LENGTH 333
+#define TEST_HEIGHT 3
+#define TEST_PADDING 37
+#define TEST_SENTINEL 0xa5
+
+static word test_palette16[256];
+static uint test_palette32[256];
+static byte test_source[TEST_LENGTH * TEST_HEIGHT];
+static byte test_expected[((TEST_LENGTH * 4) + TEST_PADDING) * TEST_HEIGHT];
+static byte test_target[((TEST_LENGTH * 4) + TEST_PADDING) * TEST_HEIGHT];
+static uint test_seed = 1;
+static const char* TEST_LEVELS[ ] = {"scalar", "sse2", "avx2"};
+
+// ----------------------------------------------------------------------------
+// Random
+// ----------------------------------------------------------------------------
+static uint test_Random( ) {
+  test_seed = test_seed * 1103515245 + 12345;
+  return test_seed >> 16;
+}
+
+// ----------------------------------------------------------------------------
+// Expect
+// ----------------------------------------------------------------------------
+static void test_Expect(uint depth, uint pitch, uint length) {
+  memset(test_expected, TEST_SENTINEL, pitch * TEST_HEIGHT);
+  for(uint indexY = 0; indexY < TEST_HEIGHT; indexY++) {
+    byte* target = test_expected + (indexY * pitch);
+    const byte* source = test_source + (indexY * length);
+    for(uint indexX = 0; indexX < length; indexX++) {
+      uint color = (depth == 2)? test_palette16[source[indexX]]: test_palette32[source[indexX]] & 0xffffff;
+      for(uint index = 0; index < depth; index++) {
+        target[(indexX * depth) + index] = (byte)(color >> (index << 3));
+      }
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Blit
+// ----------------------------------------------------------------------------
+static void test_Blit(uint depth, uint pitch, uint length) {
+  memset(test_target, TEST_SENTINEL, pitch * TEST_HEIGHT);
+  if(depth == 2) {
+    blitter_Blit16(test_target, pitch, test_source, length, TEST_HEIGHT);
+  }
+  else if(depth == 3) {
+    blitter_Blit24(test_target, pitch, test_source, length, TEST_HEIGHT);
+  }
+  else {
+    blitter_Blit32(test_target, pitch, test_source, length, TEST_HEIGHT);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+int main( ) {
+  for(uint index = 0; index < 256; index++) {
+    test_palette16[index] = (word)test_Random( );
+    test_palette32[index] = (test_Random( ) << 16) ^ test_Random( );
+  }
+  blitter_SetPalette16(test_palette16);
+  blitter_SetPalette32(test_palette32);
+
+  uint checked = 0;
+  for(byte level = BLITTER_LEVEL_SCALAR; level <= blitter_GetSupportedLevel( ); level++) {
+    if(blitter_SetLevel(level) != level) {
+      printf("Blitter: level %s was not applied\n", TEST_LEVELS[level]);
+      return 1;
+    }
+    for(uint length = 1; length <= TEST_LENGTH; length++) {
+      for(uint index = 0; index < length * TEST_HEIGHT; index++) {
+        test_source[index] = (byte)test_Random( );
+      }
+      for(uint depth = 2; depth <= 4; depth++) {
+        uint pitch = (length * depth) + (length % TEST_PADDING) + 1;
+        test_Expect(depth, pitch, length);
+        test_Blit(depth, pitch, length);
+        if(memcmp(test_expected, test_target, pitch * TEST_HEIGHT) != 0) {
+          printf("Blitter: %u-bit %s output differs at length %u\n", depth << 3, TEST_LEVELS[level], length);
+          return 1;
+        }
+        checked++;
+      }
+    }
+  }
+  printf("Blitter: %u blits identical up to %s\n", checked, TEST_LEVELS[blitter_GetSupportedLevel( )]);
+  return 0;
+}
@@ -0,0 +1,186 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// CaptureTest.cpp
+// ----------------------------------------------------------------------------
+// Runs a short capture of a small patterned picture, once written on the
+// calling thread and once on the background writer, and reads the files
+// back. The Y4M header has to describe the picture, the file has to hold one
+// plane set per stored frame and the WAV header has to agree with the samples
+// that were written.
+// ----------------------------------------------------------------------------
+#include "Capture.h"
+#include <Stdio.h>
+#include <Stdlib.h>
+#include <String.h>
+
+#define TEST_WIDTH 16
+#define TEST_HEIGHT 8
+#define TEST_FREQUENCY 60
+#define TEST_SAMPLE_RATE (TEST_FREQUENCY * 524)
+#define TEST_LENGTH (TEST_SAMPLE_RATE / TEST_FREQUENCY)
+#define TEST_FRAMES 30
+#define TEST_VIDEO "Build/CaptureTest.y4m"
+#define TEST_AUDIO "Build/CaptureTest.wav"
+
+static byte test_pixels[TEST_WIDTH * TEST_HEIGHT];
+static byte test_palette[PALETTE_SIZE];
+static short test_samples[TEST_LENGTH];
+
+// ----------------------------------------------------------------------------
+// ReadFile
+// ----------------------------------------------------------------------------
+static byte* test_ReadFile(const char* filename, uint& size) {
+  FILE* file = fopen(filename, "rb");
+  if(file == NULL) {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  size = (uint)ftell(file);
+  fseek(file, 0, SEEK_SET);
+  byte* data = new byte[size + 1];
+  if(fread(data, 1, size, file) != size) {
+    delete [ ] data;
+    data = NULL;
+  }
+  fclose(file);
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// GetUint
+// ----------------------------------------------------------------------------
+static uint test_GetUint(const byte* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+}
+
+// ----------------------------------------------------------------------------
+// CheckVideo
+// ----------------------------------------------------------------------------
+static bool test_CheckVideo(const char* mode) {
+  uint size;
+  byte* data = test_ReadFile(TEST_VIDEO, size);
+  if(data == NULL) {
+    printf("Capture: %s video could not be read\n", mode);
+    return false;
+  }
+  char header[64];
+  sprintf(header, "YUV4MPEG2 W%u H%u F%u:1 Ip C444\n", TEST_WIDTH, TEST_HEIGHT, TEST_FREQUENCY);
+  uint headerSize = strlen(header);
+  uint frameSize = 6 + (TEST_WIDTH * TEST_HEIGHT * 3);
+  bool valid = size >= headerSize && memcmp(data, header, headerSize) == 0;
+  if(!valid) {
+    printf("Capture: %s video header is wrong\n", mode);
+  }
+  else if(size != headerSize + (capture_frames * frameSize)) {
+    printf("Capture: %s video holds %u bytes, expected %u frames\n", mode, size, capture_frames);
+    valid = false;
+  }
+  for(uint index = 0; valid && index < capture_frames; index++) {
+    if(memcmp(data + headerSize + (index * frameSize), "FRAME\n", 6) != 0) {
+      printf("Capture: %s video frame %u has no marker\n", mode, index);
+      valid = false;
+    }
+  }
+  delete [ ] data;
+  return valid;
+}
+
+// ----------------------------------------------------------------------------
+// CheckAudio
+// ----------------------------------------------------------------------------
+static bool test_CheckAudio(const char* mode) {
+  uint size;
+  byte* data = test_ReadFile(TEST_AUDIO, size);
+  if(data == NULL) {
+    printf("Capture: %s audio could not be read\n", mode);
+    return false;
+  }
+  uint dataSize = capture_frames * TEST_LENGTH * 2;
+  bool valid = size == 44 + dataSize;
+  if(!valid) {
+    printf("Capture: %s audio holds %u bytes, expected %u\n", mode, size, 44 + dataSize);
+  }
+  else if(memcmp(data, "RIFF", 4) != 0 || test_GetUint(data + 4) != 36 + dataSize || memcmp(data + 8, "WAVEfmt ", 8) != 0) {
+    printf("Capture: %s audio riff header is wrong\n", mode);
+    valid = false;
+  }
+  else if(test_GetUint(data + 24) != TEST_SAMPLE_RATE || memcmp(data + 36, "data", 4) != 0 || test_GetUint(data + 40) != dataSize) {
+    printf("Capture: %s audio format or data size is wrong\n", mode);
+    valid = false;
+  }
+  delete [ ] data;
+  return valid;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+static bool test_Run(bool background) {
+  const char* mode = (background)? "background": "synchronous";
+  if(!capture_Open(TEST_VIDEO, TEST_AUDIO, TEST_WIDTH, TEST_HEIGHT, TEST_FREQUENCY, TEST_SAMPLE_RATE, background)) {
+    printf("Capture: %s capture could not be opened\n", mode);
+    return false;
+  }
+  for(uint frame = 0; frame < TEST_FRAMES; frame++) {
+    uint index;
+    for(index = 0; index < TEST_WIDTH * TEST_HEIGHT; index++) {
+      test_pixels[index] = (byte)(index + frame);
+    }
+    for(index = 0; index < TEST_LENGTH; index++) {
+      test_samples[index] = (short)((index * 64) - (frame * 256));
+    }
+    capture_Store(test_pixels, test_palette, test_samples, TEST_LENGTH);
+    if(capture_Poll( ) != CAPTURE_BUSY) {
+      printf("Capture: %s capture stopped at frame %u\n", mode, frame);
+      return false;
+    }
+  }
+  if(!capture_Close( )) {
+    printf("Capture: %s capture could not be closed\n", mode);
+    return false;
+  }
+  if(capture_frames + capture_dropped != TEST_FRAMES) {
+    printf("Capture: %s capture counted %u frames and %u drops\n", mode, capture_frames, capture_dropped);
+    return false;
+  }
+  return test_CheckVideo(mode) && test_CheckAudio(mode);
+}
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+int main( ) {
+  for(uint index = 0; index < PALETTE_SIZE; index++) {
+    test_palette[index] = (byte)(index * 7);
+  }
+  if(!test_Run(false)) {
+    return 1;
+  }
+  uint frames = capture_frames;
+  if(!test_Run(true)) {
+    return 1;
+  }
+  printf("Capture: %u synchronous and %u background frames written\n", frames, capture_frames);
+  return 0;
+}
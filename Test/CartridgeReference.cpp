@@ -0,0 +1,208 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// CartridgeReference.cpp
+// ----------------------------------------------------------------------------
+// The bank switching of Core/Cartridge.cpp as it stood before the mapper
+// table took over, when cartridge_Store and cartridge_StoreBank switched on
+// the cartridge type. CartridgeTest includes it inside a namespace and checks
+// the current dispatch against it write for write.
+// ----------------------------------------------------------------------------
+#define CARTRIDGE_MAPPER_COUNT 7
+
+struct CartridgeMapper {
+  word address;
+  uint size;
+  memoryTrap trap;
+};
+
+typedef CartridgeMapper cartridgeMapper;
+
+const byte* cartridge_buffer = NULL;
+uint cartridge_size = 0;
+byte cartridge_type;
+bool cartridge_pokey;
+byte cartridge_bank;
+
+void cartridge_StoreBank(byte bank);
+
+// ----------------------------------------------------------------------------
+// GetBankOffset
+// ----------------------------------------------------------------------------
+static uint cartridge_GetBankOffset(byte bank) {
+  return bank * 16384;
+}
+
+// ----------------------------------------------------------------------------
+// WriteBank
+// ----------------------------------------------------------------------------
+static void cartridge_WriteBank(word address, byte bank) {
+  uint offset = cartridge_GetBankOffset(bank);
+  if(offset < cartridge_size) {
+    memory_WriteROM(address, 16384, cartridge_buffer + offset);
+    cartridge_bank = bank;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Store
+// ----------------------------------------------------------------------------
+void cartridge_Store( ) {
+  switch(cartridge_type) {
+    case CARTRIDGE_TYPE_NORMAL:
+      memory_WriteROM(65536 - cartridge_size, cartridge_size, cartridge_buffer);
+      break;
+    case CARTRIDGE_TYPE_SUPERCART:
+      if(cartridge_GetBankOffset(7) < cartridge_size) {
+        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
+      }
+      break;
+    case CARTRIDGE_TYPE_SUPERCART_LARGE:
+      if(cartridge_GetBankOffset(8) < cartridge_size) {
+        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(8));
+        memory_WriteROM(16384, 16384, cartridge_buffer + cartridge_GetBankOffset(0));
+      }
+      break;
+    case CARTRIDGE_TYPE_SUPERCART_RAM:
+      if(cartridge_GetBankOffset(7) < cartridge_size) {
+        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
+        memory_ClearROM(16384, 16384);
+      }
+      break;
+    case CARTRIDGE_TYPE_SUPERCART_ROM:
+      if(cartridge_GetBankOffset(7) < cartridge_size && cartridge_GetBankOffset(6) < cartridge_size) {
+        memory_WriteROM(49152, 16384, cartridge_buffer + cartridge_GetBankOffset(7));
+        memory_WriteROM(16384, 16384, cartridge_buffer + cartridge_GetBankOffset(6));
+      }
+      break;
+    case CARTRIDGE_TYPE_ABSOLUTE:
+      memory_WriteROM(16384, 16384, cartridge_buffer);
+      memory_WriteROM(32768, 32768, cartridge_buffer + cartridge_GetBankOffset(2));
+      break;
+    case CARTRIDGE_TYPE_ACTIVISION:
+      if(122880 < cartridge_size) {
+        memory_WriteROM(40960, 16384, cartridge_buffer);
+        memory_WriteROM(16384, 8192, cartridge_buffer + 106496);
+        memory_WriteROM(24576, 8192, cartridge_buffer + 98304);
+        memory_WriteROM(32768, 8192, cartridge_buffer + 122880);
+        memory_WriteROM(57344, 8192, cartridge_buffer + 114688);
+      }
+      break;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteSupercart
+// ----------------------------------------------------------------------------
+static void cartridge_WriteSupercart(word address, byte data) {
+  if(data < 9) {
+    cartridge_StoreBank(data);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteSupercartLarge
+// ----------------------------------------------------------------------------
+static void cartridge_WriteSupercartLarge(word address, byte data) {
+  if(data < 9) {
+    cartridge_StoreBank(data + 1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteAbsolute
+// ----------------------------------------------------------------------------
+static void cartridge_WriteAbsolute(word address, byte data) {
+  if(address == 32768 && (data == 1 || data == 2)) {
+    cartridge_StoreBank(data - 1);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WriteActivision
+// ----------------------------------------------------------------------------
+static void cartridge_WriteActivision(word address, byte data) {
+  if(address >= 65408) {
+    cartridge_StoreBank(address & 7);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// WritePokey
+// ----------------------------------------------------------------------------
+static void cartridge_WritePokey(word address, byte data) {
+  if(address <= POKEY_AUDCTL) {
+    pokey_Synchronize(prosystem_GetSoundPosition( ));
+    pokey_SetRegister(address, data);
+  }
+}
+
+static const cartridgeMapper CARTRIDGE_MAPPERS[CARTRIDGE_MAPPER_COUNT] = {
+  {0, 0, NULL},
+  {32768, 16384, cartridge_WriteSupercart},
+  {32768, 16384, cartridge_WriteSupercartLarge},
+  {32768, 16384, cartridge_WriteSupercart},
+  {32768, 16384, cartridge_WriteSupercart},
+  {32768, MEMORY_PAGE_SIZE, cartridge_WriteAbsolute},
+  {65280, MEMORY_PAGE_SIZE, cartridge_WriteActivision}
+};
+
+// ----------------------------------------------------------------------------
+// Install
+// ----------------------------------------------------------------------------
+void cartridge_Install( ) {
+  memory_SetTrap(0, MEMORY_SIZE, NULL);
+  if(cartridge_type < CARTRIDGE_MAPPER_COUNT && CARTRIDGE_MAPPERS[cartridge_type].trap != NULL) {
+    memory_SetTrap(CARTRIDGE_MAPPERS[cartridge_type].address, CARTRIDGE_MAPPERS[cartridge_type].size, CARTRIDGE_MAPPERS[cartridge_type].trap);
+  }
+  if(cartridge_pokey) {
+    memory_SetTrap(POKEY_AUDF1, MEMORY_PAGE_SIZE, cartridge_WritePokey);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StoreBank
+// ----------------------------------------------------------------------------
+void cartridge_StoreBank(byte bank) {
+  switch(cartridge_type) {
+    case CARTRIDGE_TYPE_SUPERCART:
+      cartridge_WriteBank(32768, bank);
+      break;
+    case CARTRIDGE_TYPE_SUPERCART_RAM:
+      cartridge_WriteBank(32768, bank);
+      break;
+    case CARTRIDGE_TYPE_SUPERCART_ROM:
+      cartridge_WriteBank(32768, bank);
+      break;
+    case CARTRIDGE_TYPE_SUPERCART_LARGE:
+      cartridge_WriteBank(32768, bank);        
+      break;
+    case CARTRIDGE_TYPE_ABSOLUTE:
+      cartridge_WriteBank(16384, bank);
+      break;
+    case CARTRIDGE_TYPE_ACTIVISION:
+      cartridge_WriteBank(40960, bank);
+      break;
+  }  
+}
+
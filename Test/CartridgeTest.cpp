@@ -0,0 +1,317 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// CartridgeTest.cpp
+// ----------------------------------------------------------------------------
+// Loads pseudo-random images of several sizes, installs every cartridge type
+// with and without Pokey and replays the same trace of writes through the
+// current mapper table and through the type switch it replaced. Memory is
+// stubbed so that each side records which image page lands on every memory
+// page, which pages carry a trap and what reaches Pokey; the bank has to
+// agree after every write and the page maps whenever they are compared.
+// ----------------------------------------------------------------------------
+#include "ProSystem.h"
+#include <Stdio.h>
+#include <Stdlib.h>
+#include <String.h>
+
+namespace reference {
+#include "CartridgeReference.cpp"
+}
+
+#define TEST_WRITES 300000
+#define TEST_BANK_INTERVAL 997
+#define TEST_COMPARE_INTERVAL 4096
+#define TEST_TYPE_COUNT 8
+#define TEST_UNMAPPED -1
+#define TEST_CLEARED -2
+#define TEST_FILENAME "Build/CartridgeTest.bin"
+
+struct TestWrite {
+  word address;
+  byte data;
+};
+
+typedef TestWrite testWrite;
+
+struct TestSide {
+  const byte* image;
+  int page[MEMORY_PAGE_COUNT];
+  memoryTrap trap[MEMORY_PAGE_COUNT];
+  uint pokeyWrites;
+  uint pokeySum;
+  uint synchronized;
+};
+
+typedef TestSide testSide;
+
+static const uint TEST_SIZES[ ] = {49152, 65536, 131072, 147456};
+static testWrite test_trace[TEST_WRITES];
+static testSide test_sides[2];
+static testSide* test_side = &test_sides[0];
+static byte test_image[147456];
+static uint test_seed = 1;
+
+// ----------------------------------------------------------------------------
+// memory_WriteROM
+// ----------------------------------------------------------------------------
+void memory_WriteROM(word address, word size, const byte* data) {
+  if((address + size) <= MEMORY_SIZE && data != NULL && size != 0) {
+    for(uint index = address >> 8; index <= (address + size - 1u) >> 8; index++) {
+      test_side->page[index] = (int)(data - test_side->image) + (int)((index << 8) - address);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// memory_ClearROM
+// ----------------------------------------------------------------------------
+void memory_ClearROM(word address, word size) {
+  if((address + size) <= MEMORY_SIZE && size != 0) {
+    for(uint index = address >> 8; index <= (address + size - 1u) >> 8; index++) {
+      test_side->page[index] = TEST_CLEARED;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// memory_SetTrap
+// ----------------------------------------------------------------------------
+void memory_SetTrap(word address, uint size, memoryTrap trap) {
+  if(address + size <= MEMORY_SIZE && size != 0) {
+    for(uint index = address >> 8; index <= (address + size - 1u) >> 8; index++) {
+      test_side->trap[index] = trap;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// memory_SetImage
+// ----------------------------------------------------------------------------
+void memory_SetImage(byte image, const byte* data, uint size) {
+  if(image == MEMORY_IMAGE_CARTRIDGE) {
+    test_sides[0].image = data;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// pokey_SetRegister
+// ----------------------------------------------------------------------------
+void pokey_SetRegister(word address, byte data) {
+  test_side->pokeyWrites++;
+  test_side->pokeySum = (test_side->pokeySum * 31) + (address << 8) + data;
+}
+
+// ----------------------------------------------------------------------------
+// pokey_Synchronize
+// ----------------------------------------------------------------------------
+void pokey_Synchronize(uint position) {
+  test_side->synchronized++;
+}
+
+// ----------------------------------------------------------------------------
+// prosystem_GetSoundPosition
+// ----------------------------------------------------------------------------
+uint prosystem_GetSoundPosition( ) {
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// archive
+// ----------------------------------------------------------------------------
+archive* archive_Open(std::string filename) {
+  return NULL;
+}
+
+uint archive_GetCount(const archive* handle) {
+  return 0;
+}
+
+uint archive_GetSize(const archive* handle, uint index) {
+  return 0;
+}
+
+uint archive_Find(const archive* handle, std::string extensions) {
+  return ARCHIVE_NONE;
+}
+
+uint archive_Read(archive* handle, uint index, byte* data, uint size) {
+  return 0;
+}
+
+uint archive_Read(archive* handle, uint index, byte* data, uint size, hashContext& context, archiveRange range) {
+  return 0;
+}
+
+void archive_Close(archive* handle) {
+}
+
+// ----------------------------------------------------------------------------
+// Random
+// ----------------------------------------------------------------------------
+static uint test_Random( ) {
+  test_seed = test_seed * 1103515245 + 12345;
+  return test_seed >> 16;
+}
+
+// ----------------------------------------------------------------------------
+// CreateTrace
+// ----------------------------------------------------------------------------
+static void test_CreateTrace( ) {
+  static const word ADDRESSES[ ] = {32768, 32768, 49152, 65408, 65280, POKEY_AUDF1, 16384};
+  for(uint index = 0; index < TEST_WRITES; index++) {
+    uint choice = test_Random( ) % 10;
+    word address = (word)test_Random( );
+    if(choice == 0) {
+      address = ADDRESSES[choice];
+    }
+    else if(choice < 7) {
+      address = ADDRESSES[choice] + (test_Random( ) & 255);
+    }
+    test_trace[index].address = address;
+    test_trace[index].data = (byte)((test_Random( ) & 1)? test_Random( ) % 12: test_Random( ));
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Reset
+// ----------------------------------------------------------------------------
+static void test_Reset(testSide& side, const byte* image) {
+  side.image = image;
+  for(uint index = 0; index < MEMORY_PAGE_COUNT; index++) {
+    side.page[index] = TEST_UNMAPPED;
+    side.trap[index] = NULL;
+  }
+  side.pokeyWrites = 0;
+  side.pokeySum = 0;
+  side.synchronized = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Write
+// ----------------------------------------------------------------------------
+static void test_Write(uint side, word address, byte data) {
+  test_side = &test_sides[side];
+  if(test_side->trap[address >> 8] != NULL) {
+    test_side->trap[address >> 8](address, data);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Compare
+// ----------------------------------------------------------------------------
+static bool test_Compare( ) {
+  const testSide& current = test_sides[0];
+  const testSide& expected = test_sides[1];
+  for(uint index = 0; index < MEMORY_PAGE_COUNT; index++) {
+    if(current.page[index] != expected.page[index] || (current.trap[index] == NULL) != (expected.trap[index] == NULL)) {
+      return false;
+    }
+  }
+  return current.pokeyWrites == expected.pokeyWrites && current.pokeySum == expected.pokeySum && current.synchronized == expected.synchronized;
+}
+
+// ----------------------------------------------------------------------------
+// Replay
+// ----------------------------------------------------------------------------
+static bool test_Replay(uint size, byte type, bool pokey) {
+  const byte* image = test_sides[0].image;
+  test_Reset(test_sides[0], image);
+  test_Reset(test_sides[1], test_image);
+  cartridge_type = reference::cartridge_type = type;
+  cartridge_pokey = reference::cartridge_pokey = pokey;
+  cartridge_bank = reference::cartridge_bank = 0;
+
+  test_side = &test_sides[0];
+  cartridge_Install( );
+  cartridge_Store( );
+  test_side = &test_sides[1];
+  reference::cartridge_Install( );
+  reference::cartridge_Store( );
+  if(!test_Compare( )) {
+    printf("Cartridge: type %u of %u bytes is stored differently\n", type, size);
+    return false;
+  }
+
+  for(uint index = 0; index < TEST_WRITES; index++) {
+    const testWrite& write = test_trace[index];
+    if(index % TEST_BANK_INTERVAL == 0) {
+      test_side = &test_sides[0];
+      cartridge_StoreBank(write.data);
+      test_side = &test_sides[1];
+      reference::cartridge_StoreBank(write.data);
+    }
+    else {
+      test_Write(0, write.address, write.data);
+      test_Write(1, write.address, write.data);
+    }
+    if(cartridge_bank != reference::cartridge_bank || ((index % TEST_COMPARE_INTERVAL) == 0 && !test_Compare( ))) {
+      printf("Cartridge: type %u of %u bytes%s differs at write %u\n", type, size, (pokey)? " with pokey": "", index);
+      return false;
+    }
+  }
+  if(!test_Compare( )) {
+    printf("Cartridge: type %u of %u bytes%s differs after the trace\n", type, size, (pokey)? " with pokey": "");
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+int main( ) {
+  cartridge_cacheSize = 0;
+  test_CreateTrace( );
+  uint replayed = 0;
+  for(uint sizeIndex = 0; sizeIndex < sizeof(TEST_SIZES) / sizeof(TEST_SIZES[0]); sizeIndex++) {
+    uint size = TEST_SIZES[sizeIndex];
+    for(uint index = 0; index < size; index++) {
+      test_image[index] = (byte)test_Random( );
+    }
+    test_image[1] = 0;
+
+    FILE* file = fopen(TEST_FILENAME, "wb");
+    if(file == NULL || fwrite(test_image, 1, size, file) != size) {
+      printf("Cartridge: %s could not be written\n", TEST_FILENAME);
+      return 1;
+    }
+    fclose(file);
+    if(!cartridge_Load(TEST_FILENAME)) {
+      printf("Cartridge: %s could not be loaded\n", TEST_FILENAME);
+      return 1;
+    }
+    reference::cartridge_buffer = test_image;
+    reference::cartridge_size = size;
+
+    for(byte type = 0; type < TEST_TYPE_COUNT; type++) {
+      if(!test_Replay(size, type, false) || !test_Replay(size, type, true)) {
+        return 1;
+      }
+      replayed += 2;
+    }
+    cartridge_Release( );
+  }
+  printf("Cartridge: %u traces of %u writes identical\n", replayed, TEST_WRITES);
+  return 0;
+}
@@ -0,0 +1,6 @@
+// Cpuid.h
+// ----------------------------------------------------------------------------
+// Forwards the capitalised include used by the sources to the system header
+// on case-sensitive file systems.
+// ----------------------------------------------------------------------------
+#include_next <cpuid.h>
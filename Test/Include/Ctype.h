@@ -0,0 +1,9 @@
+// Ctype.h
+// ----------------------------------------------------------------------------
+// Forwards the capitalised include used by the sources to the system header
+// on case-sensitive file systems, and keeps NULL defined as 0 the way the
+// sources define it so that their own definitions do not clash.
+// ----------------------------------------------------------------------------
+#include <ctype.h>
+#undef NULL
+#define NULL 0
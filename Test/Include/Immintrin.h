@@ -0,0 +1,6 @@
+// Immintrin.h
+// ----------------------------------------------------------------------------
+// Forwards the capitalised include used by the sources to the system header
+// on case-sensitive file systems.
+// ----------------------------------------------------------------------------
+#include_next <immintrin.h>
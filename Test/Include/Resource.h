@@ -0,0 +1,6 @@
+// Resource.h
+// ----------------------------------------------------------------------------
+// Forwards the capitalised include used by the sources to the resource
+// header in Win on case-sensitive file systems.
+// ----------------------------------------------------------------------------
+#include "../../Win/resource.h"
@@ -0,0 +1,6 @@
+// ioapi.h
+// ----------------------------------------------------------------------------
+// Forwards the lower-case include used by the zip headers to the copy in Lib
+// on case-sensitive file systems.
+// ----------------------------------------------------------------------------
+#include "../../Lib/Ioapi.h"
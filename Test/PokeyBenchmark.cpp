@@ -0,0 +1,188 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// PokeyBenchmark.cpp
+// ----------------------------------------------------------------------------
+// Plays the same pseudo-random register trace through the reference and the
+// current pokey_Process. The first pass drives both with identical lengths
+// and compares every frame; the second drives each the way the emulator does
+// (per scanline for the reference, synchronized on writes for the current
+// code), compares again and reports the timings.
+// ----------------------------------------------------------------------------
+#include <Stdio.h>
+#include <Stdlib.h>
+#include <String.h>
+#include <Time.h>
+#include "Pokey.h"
+
+namespace reference {
+#include "PokeyReference.cpp"
+}
+
+#define BENCHMARK_FRAMES 20000
+#define BENCHMARK_WRITES 12
+#define BENCHMARK_SAMPLES 524
+
+struct BenchmarkWrite {
+  uint position;
+  word address;
+  byte value;
+};
+
+typedef BenchmarkWrite benchmarkWrite;
+
+static benchmarkWrite benchmark_trace[BENCHMARK_FRAMES][BENCHMARK_WRITES];
+static uint benchmark_seed = 1;
+
+// ----------------------------------------------------------------------------
+// Random
+// ----------------------------------------------------------------------------
+static uint benchmark_Random( ) {
+  benchmark_seed = benchmark_seed * 1103515245 + 12345;
+  return benchmark_seed >> 16;
+}
+
+// ----------------------------------------------------------------------------
+// BuildTrace
+// ----------------------------------------------------------------------------
+static void benchmark_BuildTrace( ) {
+  for(uint frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    uint position = 0;
+    for(uint index = 0; index < BENCHMARK_WRITES; index++) {
+      benchmarkWrite& entry = benchmark_trace[frame][index];
+      position += (benchmark_Random( ) % (BENCHMARK_SAMPLES / BENCHMARK_WRITES)) & ~1;
+      entry.position = position;
+      uint pick = benchmark_Random( ) % 16;
+      if(pick == 0) {
+        entry.address = POKEY_AUDCTL;
+        entry.value = benchmark_Random( ) & 0xff;
+      }
+      else if(pick < 9) {
+        entry.address = POKEY_AUDF1 + (((pick - 1) & 3) << 1);
+        entry.value = benchmark_Random( ) & 0xff;
+      }
+      else {
+        entry.address = POKEY_AUDC1 + (((pick - 9) & 3) << 1);
+        entry.value = (benchmark_Random( ) & 0xe0) | (1 + benchmark_Random( ) % 15);
+      }
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Elapsed
+// ----------------------------------------------------------------------------
+static double benchmark_Elapsed(clock_t start) {
+  return (double)(clock( ) - start) / CLOCKS_PER_SEC;
+}
+
+// ----------------------------------------------------------------------------
+// Compare
+// ----------------------------------------------------------------------------
+static bool benchmark_Compare( ) {
+  reference::pokey_Reset( );
+  pokey_Reset( );
+  for(uint frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    uint position = 0;
+    for(uint index = 0; index <= BENCHMARK_WRITES; index++) {
+      uint next = (index < BENCHMARK_WRITES)? benchmark_trace[frame][index].position: BENCHMARK_SAMPLES;
+      if(next > position) {
+        reference::pokey_Process(next - position);
+        pokey_Process(next - position);
+        position = next;
+      }
+      if(index < BENCHMARK_WRITES) {
+        reference::pokey_SetRegister(benchmark_trace[frame][index].address, benchmark_trace[frame][index].value);
+        pokey_SetRegister(benchmark_trace[frame][index].address, benchmark_trace[frame][index].value);
+      }
+    }
+    if(memcmp(reference::pokey_buffer, pokey_buffer, BENCHMARK_SAMPLES) != 0) {
+      printf("Pokey: output differs in frame %u\n", frame);
+      return false;
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// RunReference
+// ----------------------------------------------------------------------------
+static double benchmark_RunReference(uint& checksum) {
+  reference::pokey_Reset( );
+  clock_t start = clock( );
+  for(uint frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    uint index = 0;
+    for(uint position = 0; position < BENCHMARK_SAMPLES; position += 2) {
+      while(index < BENCHMARK_WRITES && benchmark_trace[frame][index].position <= position) {
+        reference::pokey_SetRegister(benchmark_trace[frame][index].address, benchmark_trace[frame][index].value);
+        index++;
+      }
+      reference::pokey_Process(2);
+    }
+    for(uint sample = 0; sample < BENCHMARK_SAMPLES; sample++) {
+      checksum = (checksum * 31) + reference::pokey_buffer[sample];
+    }
+  }
+  return benchmark_Elapsed(start);
+}
+
+// ----------------------------------------------------------------------------
+// RunCurrent
+// ----------------------------------------------------------------------------
+static double benchmark_RunCurrent(uint& checksum) {
+  pokey_Reset( );
+  clock_t start = clock( );
+  for(uint frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+    for(uint index = 0; index < BENCHMARK_WRITES; index++) {
+      pokey_Synchronize(benchmark_trace[frame][index].position);
+      pokey_SetRegister(benchmark_trace[frame][index].address, benchmark_trace[frame][index].value);
+    }
+    pokey_Synchronize(BENCHMARK_SAMPLES);
+    for(uint sample = 0; sample < BENCHMARK_SAMPLES; sample++) {
+      checksum = (checksum * 31) + pokey_buffer[sample];
+    }
+  }
+  return benchmark_Elapsed(start);
+}
+
+// ----------------------------------------------------------------------------
+// main
+// ----------------------------------------------------------------------------
+int main( ) {
+  benchmark_BuildTrace( );
+  if(!benchmark_Compare( )) {
+    return 1;
+  }
+
+  uint first = 0;
+  uint second = 0;
+  double reference = benchmark_RunReference(first);
+  double current = benchmark_RunCurrent(second);
+  if(first != second) {
+    printf("Pokey: scanline-driven output differs from synchronized output\n");
+    return 1;
+  }
+  printf("Pokey: %u frames identical\n", BENCHMARK_FRAMES);
+  printf("Pokey: reference %.3f s, current %.3f s (%.2fx)\n", reference, current, reference / current);
+  return 0;
+}
@@ -0,0 +1,242 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Batch.cpp
+// ----------------------------------------------------------------------------
+#include "Batch.h"
+#define BATCH_INPUT_SIZE 19
+
+uint batch_frames = 0;
+std::string batch_wavFilename;
+std::string batch_recordFilename;
+std::string batch_playFilename;
+std::string batch_captureFilename[2];
+std::string batch_traceFilename;
+std::string batch_compareFilename[2];
+std::string batch_scanPath;
+std::string batch_scanFilename;
+int batch_result = 1;
+static bool batch_recording = false;
+
+// ----------------------------------------------------------------------------
+// IsEnabled
+// ----------------------------------------------------------------------------
+bool batch_IsEnabled( ) {
+  return batch_frames != 0 || !batch_compareFilename[0].empty( ) || !batch_scanPath.empty( );
+}
+
+// ----------------------------------------------------------------------------
+// AttachConsole
+// ----------------------------------------------------------------------------
+void batch_AttachConsole( ) {
+  typedef BOOL (WINAPI *attachConsole)(DWORD);
+  attachConsole attach = (attachConsole)GetProcAddress(GetModuleHandle("kernel32.dll"), "AttachConsole");
+  if(attach != NULL && attach((DWORD)-1)) {
+    freopen("CONOUT$", "w", stdout);
+    freopen("CONOUT$", "w", stderr);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StartMovie
+// ----------------------------------------------------------------------------
+bool batch_StartMovie( ) {
+  if(!batch_playFilename.empty( )) {
+    std::string filename = batch_playFilename;
+    batch_playFilename = "";
+    return movie_Load(filename) && movie_Play( );
+  }
+  if(!batch_recordFilename.empty( ) && !batch_recording) {
+    batch_recording = movie_Record( );
+    return batch_recording;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// StopMovie
+// ----------------------------------------------------------------------------
+bool batch_StopMovie( ) {
+  if(!batch_recording) {
+    return true;
+  }
+  batch_recording = false;
+  movie_Stop( );
+  std::string filename = batch_recordFilename;
+  batch_recordFilename = "";
+  return movie_Save(filename, common_GetExtension(filename) == ".zip");
+}
+
+// ----------------------------------------------------------------------------
+// StartCapture
+// ----------------------------------------------------------------------------
+bool batch_StartCapture( ) {
+  if(batch_captureFilename[0].empty( )) {
+    return true;
+  }
+  std::string videoFilename = batch_captureFilename[0];
+  std::string audioFilename = batch_captureFilename[1];
+  batch_captureFilename[0] = "";
+  batch_captureFilename[1] = "";
+  return prosystem_OpenCapture(videoFilename, audioFilename, !batch_IsEnabled( ));
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+bool batch_Run(std::string filename) {
+  batch_result = 1;
+  if(!cartridge_Load(filename)) {
+    return false;
+  }
+  database_Load(cartridge_digest);
+  prosystem_Reset( );
+  audio_SetSampleRate(samplerate);
+  audio_Reset( );
+  if(!batch_StartMovie( )) {
+    prosystem_Close( );
+    return false;
+  }
+  if(!batch_wavFilename.empty( ) && !audio_OpenFile(batch_wavFilename)) {
+    prosystem_Close( );
+    return false;
+  }
+  if(!batch_traceFilename.empty( ) && !checksum_Open(batch_traceFilename)) {
+    audio_CloseFile( );
+    prosystem_Close( );
+    return false;
+  }
+  if(!batch_StartCapture( )) {
+    audio_CloseFile( );
+    checksum_Close( );
+    prosystem_Close( );
+    return false;
+  }
+
+  byte input[BATCH_INPUT_SIZE] = {0};
+  short samples[MIXER_BUFFER_SIZE];
+  uint total = 0;
+  uint frames = 0;
+  bool playing = (movie_mode == MOVIE_MODE_PLAY);
+  maria_rendering = capture_active;
+  while(frames < batch_frames) {
+    if(!movie_Process(input) && playing) {
+      break;
+    }
+    prosystem_ExecuteFrame(input);
+    checksum_Store( );
+    prosystem_StoreCapture( );
+    audio_Write(samples, mixer_Mix(samples, MIXER_BUFFER_SIZE));
+    total += audio_Drain( );
+    frames++;
+  }
+  maria_rendering = true;
+  audio_CloseFile( );
+  checksum_Close( );
+  uint captured = capture_frames;
+  bool capturing = capture_active;
+  bool result = capture_Close( );
+  result = batch_StopMovie( ) && result;
+
+  printf("%s: %u frames, %u samples at %u Hz\n", filename.c_str( ), frames, total, mixer_GetSampleRate( ));
+  if(playing) {
+    printf("movie: frame %u of %u\n", movie_GetFrame( ), movie_GetLength( ));
+  }
+  if(capturing) {
+    printf("capture: %u frames\n", captured);
+  }
+  prosystem_Close( );
+  if(result) {
+    batch_result = 0;
+  }
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// Compare
+// ----------------------------------------------------------------------------
+bool batch_Compare( ) {
+  batch_result = 1;
+  uint frame;
+  uint page;
+  if(!checksum_Compare(batch_compareFilename[0], batch_compareFilename[1], frame, page)) {
+    return false;
+  }
+  if(frame == CHECKSUM_NONE) {
+    printf("traces match\n");
+    batch_result = 0;
+  }
+  else if(page == CHECKSUM_NONE) {
+    printf("traces diverge at frame %u, which only one trace records\n", frame);
+  }
+  else if(page == CHECKSUM_REGISTERS) {
+    printf("traces diverge at frame %u in the registers\n", frame);
+  }
+  else {
+    printf("traces diverge at frame %u in page %02x\n", frame, page);
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Scan
+// ----------------------------------------------------------------------------
+bool batch_Scan( ) {
+  batch_result = 1;
+  if(!library_Scan(batch_scanPath)) {
+    return false;
+  }
+  FILE* file = fopen(batch_scanFilename.c_str( ), "w");
+  if(file == NULL) {
+    logger_LogError(IDS_LIBRARY3, batch_scanFilename);
+    return false;
+  }
+
+  uint valid = 0;
+  uint known = 0;
+  fprintf(file, "Filename\tSize\tValid\tKnown\tDigest\tRomSize\tTitle\tType\tPokey\tController1\tController2\tRegion\tFlags\n");
+  for(uint index = 0; index < library_GetCount( ); index++) {
+    const libraryEntry& entry = library_GetEntry(index);
+    const cartridgeInfo& info = (entry.known)? entry.info: entry.header;
+    fprintf(file, "%s\t%u\t%u\t%u\t", entry.filename.c_str( ), entry.size, entry.valid, entry.known);
+    if(entry.valid) {
+      fprintf(file, "%s\t%u\t%s\t%u\t%u\t%u\t%u\t%u\t%u\n", info.digest.c_str( ), entry.header.size, info.title.c_str( ), info.type, info.pokey, info.controller[0], info.controller[1], info.region, info.flags);
+    }
+    else {
+      fprintf(file, "\t\t\t\t\t\t\t\t\n");
+    }
+    valid += entry.valid;
+    known += entry.known;
+  }
+  bool result = ferror(file) == 0;
+  fclose(file);
+  if(!result) {
+    logger_LogError(IDS_LIBRARY3, batch_scanFilename);
+    return false;
+  }
+
+  printf("%s: %u files, %u valid, %u known, %u cached\n", batch_scanPath.c_str( ), library_GetCount( ), valid, known, library_hits);
+  library_Release( );
+  batch_result = 0;
+  return true;
+}
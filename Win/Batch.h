@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Batch.h
+// ----------------------------------------------------------------------------
+#ifndef BATCH_H
+#define BATCH_H
+#define NULL 0
+
+#include <Windows.h>
+#include <String>
+#include <Stdio.h>
+#include "ProSystem.h"
+#include "Audio.h"
+#include "Movie.h"
+#include "Checksum.h"
+#include "Database.h"
+#include "Library.h"
+#include "Capture.h"
+#include "Configuration.h"
+#include "Logger.h"
+#include "Common.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+extern bool batch_IsEnabled( );
+extern void batch_AttachConsole( );
+extern bool batch_StartMovie( );
+extern bool batch_StopMovie( );
+extern bool batch_StartCapture( );
+extern bool batch_Run(std::string filename);
+extern bool batch_Compare( );
+extern bool batch_Scan( );
+extern uint batch_frames;
+extern std::string batch_wavFilename;
+extern std::string batch_recordFilename;
+extern std::string batch_playFilename;
+extern std::string batch_captureFilename[2];
+extern std::string batch_traceFilename;
+extern std::string batch_compareFilename[2];
+extern std::string batch_scanPath;
+extern std::string batch_scanFilename;
+extern int batch_result;
+
+#endif
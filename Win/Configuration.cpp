@@ -106,6 +106,67 @@ std::string configuration_CommandLine(std::string commandLine) {
 		}
       }
 
+	  else if ( strstr(argv[i],"-Headless") || strstr(argv[i],"-headless") ) {
+        if ( ++i < argc ) {
+          batch_frames = atoi(argv[i]);
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Wav") || strstr(argv[i],"-wav") ) {
+        if ( ++i < argc ) {
+          tmp_string = argv[i];
+          batch_wavFilename = common_Remove(tmp_string,'"');
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Record") || strstr(argv[i],"-record") ) {
+        if ( ++i < argc ) {
+          tmp_string = argv[i];
+          batch_recordFilename = common_Remove(tmp_string,'"');
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Play") || strstr(argv[i],"-play") ) {
+        if ( ++i < argc ) {
+          tmp_string = argv[i];
+          batch_playFilename = common_Remove(tmp_string,'"');
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Capture") || strstr(argv[i],"-capture") ) {
+        if ( i + 2 < argc ) {
+          tmp_string = argv[++i];
+          batch_captureFilename[0] = common_Remove(tmp_string,'"');
+          tmp_string = argv[++i];
+          batch_captureFilename[1] = common_Remove(tmp_string,'"');
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Trace") || strstr(argv[i],"-trace") ) {
+        if ( ++i < argc ) {
+          tmp_string = argv[i];
+          batch_traceFilename = common_Remove(tmp_string,'"');
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Compare") || strstr(argv[i],"-compare") ) {
+        if ( i + 2 < argc ) {
+          tmp_string = argv[++i];
+          batch_compareFilename[0] = common_Remove(tmp_string,'"');
+          tmp_string = argv[++i];
+          batch_compareFilename[1] = common_Remove(tmp_string,'"');
+		}
+      }
+
+	  else if ( strstr(argv[i],"-Scan") || strstr(argv[i],"-scan") ) {
+        if ( i + 2 < argc ) {
+          tmp_string = argv[++i];
+          batch_scanPath = common_Remove(tmp_string,'"');
+          tmp_string = argv[++i];
+          batch_scanFilename = common_Remove(tmp_string,'"');
+		}
+      }
+
 	  else if ( strstr(argv[i],"-Region") || strstr(argv[i],"-region") ) {
         if ( ++i < argc ) {
           if ( strstr(argv[i],"PAL") )
@@ -232,6 +293,10 @@ std::string configuration_Load(std::string filename, std::string commandLine) {
 
   region_type = configuration_ReadPrivateUint(CONFIGURATION_SECTION_EMULATION, "Region", 2);
   console_frameSkip = configuration_ReadPrivateUint(CONFIGURATION_SECTION_EMULATION, "Frame.Skip", 0);
+  console_runAhead = configuration_ReadPrivateUint(CONFIGURATION_SECTION_EMULATION, "Run.Ahead", 0);
+  if(console_runAhead > PRO_SYSTEM_RUN_AHEAD_MAX) {
+    console_runAhead = PRO_SYSTEM_RUN_AHEAD_MAX;
+  }
   
   if(configuration_HasKey(CONFIGURATION_SECTION_EMULATION, "Bios.Enabled") && configuration_HasKey(CONFIGURATION_SECTION_EMULATION, "Bios.Filename")) {
     bios_enabled = configuration_ReadPrivateBool(CONFIGURATION_SECTION_EMULATION, "Bios.Enabled", "false");
@@ -239,6 +304,8 @@ std::string configuration_Load(std::string filename, std::string commandLine) {
       bios_Load(configuration_ReadPrivatePath(CONFIGURATION_SECTION_EMULATION, "Bios.Filename", ""));
     }
   }
+  boot_enabled = configuration_ReadPrivateBool(CONFIGURATION_SECTION_EMULATION, "Boot.Cache", "true");
+  cartridge_cacheSize = configuration_ReadPrivateUint(CONFIGURATION_SECTION_EMULATION, "Cartridge.Cache", CARTRIDGE_CACHE_SIZE);
   
   if(configuration_HasKey(CONFIGURATION_SECTION_EMULATION, "Database.Enabled") && configuration_HasKey(CONFIGURATION_SECTION_EMULATION, "Database.Filename")) {
     database_enabled = configuration_ReadPrivateBool(CONFIGURATION_SECTION_EMULATION, "Database.Enabled", "true");
@@ -293,8 +360,11 @@ void configuration_Save(std::string filename) {
 
   configuration_WritePrivateUint(CONFIGURATION_SECTION_EMULATION, "Region", region_type);
   configuration_WritePrivateUint(CONFIGURATION_SECTION_EMULATION, "Frame.Skip", console_frameSkip);
+  configuration_WritePrivateUint(CONFIGURATION_SECTION_EMULATION, "Run.Ahead", console_runAhead);
   configuration_WritePrivatePath(CONFIGURATION_SECTION_EMULATION, "Bios.Filename", bios_filename);
   configuration_WritePrivateBool(CONFIGURATION_SECTION_EMULATION, "Bios.Enabled", bios_enabled);
+  configuration_WritePrivateBool(CONFIGURATION_SECTION_EMULATION, "Boot.Cache", boot_enabled);
+  configuration_WritePrivateUint(CONFIGURATION_SECTION_EMULATION, "Cartridge.Cache", cartridge_cacheSize);
   configuration_WritePrivatePath(CONFIGURATION_SECTION_EMULATION, "Database.Filename", database_filename);
   configuration_WritePrivateBool(CONFIGURATION_SECTION_EMULATION, "Database.Enabled", database_enabled);
 
@@ -30,6 +30,7 @@ std::string console_savePath;
 std::string console_SSS;
 
 byte console_frameSkip = 0;
+byte console_runAhead = 0;
 byte nf=0;
 
 static const DWORD CONSOLE_WINDOW_STYLE = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX;
@@ -78,11 +79,27 @@ static void console_SetCursorVisible(bool visible) {
   }
 }
 
+// ----------------------------------------------------------------------------
+// IsRewinding
+// ----------------------------------------------------------------------------
+static bool console_IsRewinding( ) {
+  return GetForegroundWindow( ) == console_hWnd && (GetAsyncKeyState(VK_BACK) & 0x8000) != 0;
+}
+
 // ----------------------------------------------------------------------------
 // Exit
 // ----------------------------------------------------------------------------
 void console_Exit( ) {
   configuration_Save(common_defaultPath + "ProSystem.ini");
+  batch_StopMovie( );
+  rewind_Release( );
+  movie_Release( );
+  checksum_Close( );
+  capture_Close( );
+  writer_Release( );
+  image_Release( );
+  database_Release( );
+  cartridge_ReleaseCache( );
   sound_Release( );
   display_Release( );
   input_Release( );
@@ -93,6 +110,8 @@ void console_Exit( ) {
 // Close
 // ----------------------------------------------------------------------------
 static void console_Close( ) {
+  batch_StopMovie( );
+  capture_Close( );
   prosystem_Close( );
   display_Clear( );
   sound_Stop( );
@@ -119,6 +138,9 @@ static void console_Pause(bool pause) {
 static void console_Reset( ) {
   sound_Stop( );
   prosystem_Reset( );
+  boot_Restore( );
+  rewind_Reset( );
+  movie_Stop( );
   sound_Play( );
 }
 
@@ -231,6 +253,8 @@ static void console_Load( ) {
   if(GetOpenFileName(&loadDialog)) {
     sound_Stop( );
     if(prosystem_Load(loadDialog.lpstrFile)) {
+      rewind_Reset( );
+      movie_Stop( );
       console_savePath = loadDialog.lpstrFile;
       console_Pause(false);
     }
@@ -260,10 +284,7 @@ static void console_Save( ) {
   saveDialog.lpstrInitialDir = console_savePath.c_str( );
 
   if(GetSaveFileName(&saveDialog)) {
-    if(!prosystem_Save(saveDialog.lpstrFile, (saveDialog.nFilterIndex == 3)? true: false)) {
-      logger_LogError(IDS_CONSOLE7,"");    
-    }
-    else {
+    if(prosystem_Save(saveDialog.lpstrFile, (saveDialog.nFilterIndex == 3)? true: false)) {
       console_savePath = saveDialog.lpstrFile;
     }
   }
@@ -413,12 +434,10 @@ std::string console_S;
   nf++;
   strcat(buf,"_");
   strcat(buf,bbf);
-  strcat(buf,".bmp");
+  strcat(buf,".png");
     
 
-    if(!display_TakeScreenshot(buf)) {
-      logger_LogError(IDS_CONSOLE1,"");
-    }
+  display_TakeScreenshot(buf);
   if(!menu_IsEnabled( ) && display_IsFullscreen( )) {
     console_SetCursorVisible(false);
   }
@@ -878,6 +897,19 @@ bool console_Initialize(HINSTANCE hInstance, std::string commandLine) {
   timer_Initialize( );
   console_hInstance = hInstance;
   romfile = configuration_Load(common_defaultPath + "ProSystem.ini", commandLine);
+  if(batch_IsEnabled( )) {
+    batch_AttachConsole( );
+    if(!batch_compareFilename[0].empty( )) {
+      batch_Compare( );
+    }
+    else if(!batch_scanPath.empty( )) {
+      batch_Scan( );
+    }
+    else {
+      batch_Run(common_Remove(romfile, '"'));
+    }
+    return false;
+  }
 
   // Setup Display for Fullscreen or Windowed
   if ( display_fullscreen ) {
@@ -929,6 +961,9 @@ bool console_Initialize(HINSTANCE hInstance, std::string commandLine) {
     logger_LogError(IDS_CONSOLE6,"");
     return false;
   }
+  rewind_Initialize(REWIND_ARENA_SIZE);
+  boot_path = common_defaultPath + "Boot\\";
+  CreateDirectory(boot_path.c_str( ), NULL);
 
   ShowWindow(console_hWnd, SW_SHOW);
   display_Clear( );
@@ -958,11 +993,23 @@ void console_Run( ) {
         return;
       }
     }
+    writer_Poll( );
+    image_Poll( );
+    capture_Poll( );
     byte data[19];
     input_GetKeyboardState(data);
     if(prosystem_active && !prosystem_paused && !console_suspended) {
       if(!console_rendering) {
-        prosystem_ExecuteFrame(data);
+        if(console_IsRewinding( ) && movie_mode == MOVIE_MODE_NONE && rewind_GetCount( ) > 2) {
+          rewind_Step( );
+          rewind_Step( );
+        }
+        movie_Process(data);
+        prosystem_RunAhead(data, console_runAhead);
+        checksum_Store( );
+        prosystem_StoreCapture( );
+        boot_Store( );
+        rewind_Store( );
         console_rendering = true;
       }
       else if(timer_IsTime( )) {
@@ -983,8 +1030,16 @@ void console_Open(std::string filename) {
   if(cartridge_Load(filename)) {
     sound_Stop( );
     display_Clear( );
-    database_Load(cartridge_digest);
+    if(!cartridge_cached) {
+      database_Load(cartridge_digest);
+    }
     prosystem_Reset( );
+    boot_Restore( );
+    rewind_Reset( );
+    batch_StopMovie( );
+    movie_Stop( );
+    batch_StartMovie( );
+    batch_StartCapture( );
     std::string title = std::string(CONSOLE_TITLE) + " - " + common_Trim(cartridge_title);
     SetWindowText(console_hWnd, title.c_str( ));
     console_AddRecent(filename);
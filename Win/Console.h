@@ -39,6 +39,12 @@
 #include "Sound.h"
 #include "Timer.h"
 #include "ProSystem.h"
+#include "Rewind.h"
+#include "Movie.h"
+#include "Boot.h"
+#include "Checksum.h"
+#include "Capture.h"
+#include "Batch.h"
 #include "Help.h"
 #include "About.h"
 
@@ -59,5 +65,6 @@ extern void console_Exit(void);
 extern std::string console_recent[10];
 extern std::string console_savePath;
 extern byte console_frameSkip;
+extern byte console_runAhead;
 
 #endif
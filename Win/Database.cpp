@@ -23,15 +23,286 @@
 // Database.cpp
 // ----------------------------------------------------------------------------
 #include "Database.h"
+#define DATABASE_INDEX_HEADER "PRO-SYSTEM INDEX"
+#define DATABASE_INDEX_VERSION 1
+#define DATABASE_INDEX_HEADER_SIZE (16 + 1 + 4 + 4 + 4 + 4 + 4)
+#define DATABASE_DIGEST_SIZE 16
+#define DATABASE_RECORD_SIZE (DATABASE_DIGEST_SIZE + 5 + 4 + 4)
+
+struct DatabaseRecord {
+  byte digest[DATABASE_DIGEST_SIZE];
+  byte type;
+  bool pokey;
+  byte controller[2];
+  byte region;
+  uint flags;
+  std::string title;
+};
+
+typedef DatabaseRecord databaseRecord;
 
 bool database_enabled = true;
 std::string database_filename;
 
+static byte* database_index = NULL;
+static HANDLE database_mapping = NULL;
+static const byte* database_records = NULL;
+static const byte* database_titles = NULL;
+static uint database_count = 0;
+static uint database_titleSize = 0;
+static std::string database_source;
+static uint database_size = 0;
+static uint database_modified = 0;
+
 static std::string database_GetValue(std::string entry) {
   int index = entry.rfind('=');
   return entry.substr(index + 1);
 }
 
+// ----------------------------------------------------------------------------
+// GetIndexFilename
+// ----------------------------------------------------------------------------
+static std::string database_GetIndexFilename( ) {
+  return common_defaultPath + "ProSystem.idx";
+}
+
+// ----------------------------------------------------------------------------
+// ParseDigest
+// ----------------------------------------------------------------------------
+static bool database_ParseDigest(std::string text, byte* digest) {
+  if(text.size( ) < (DATABASE_DIGEST_SIZE << 1)) {
+    return false;
+  }
+  for(uint index = 0; index < (DATABASE_DIGEST_SIZE << 1); index++) {
+    char value = tolower(text[index]);
+    byte nibble;
+    if(value >= '0' && value <= '9') {
+      nibble = value - '0';
+    }
+    else if(value >= 'a' && value <= 'f') {
+      nibble = value - 'a' + 10;
+    }
+    else {
+      return false;
+    }
+    digest[index >> 1] = (index & 1)? (digest[index >> 1] | nibble): (nibble << 4);
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// CompareDigest
+// ----------------------------------------------------------------------------
+static int database_CompareDigest(const byte* digest1, const byte* digest2) {
+  for(uint index = 0; index < DATABASE_DIGEST_SIZE; index++) {
+    if(digest1[index] != digest2[index]) {
+      return (digest1[index] < digest2[index])? -1: 1;
+    }
+  }
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// IsOrdered
+// ----------------------------------------------------------------------------
+static bool database_IsOrdered(const databaseRecord& record1, const databaseRecord& record2) {
+  return database_CompareDigest(record1.digest, record2.digest) < 0;
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void database_Release( ) {
+  if(database_mapping != NULL) {
+    UnmapViewOfFile(database_index);
+    CloseHandle(database_mapping);
+    database_mapping = NULL;
+  }
+  else if(database_index != NULL) {
+    delete [ ] database_index;
+  }
+  database_index = NULL;
+  database_records = NULL;
+  database_titles = NULL;
+  database_count = 0;
+  database_titleSize = 0;
+  database_source = "";
+}
+
+// ----------------------------------------------------------------------------
+// Attach
+// ----------------------------------------------------------------------------
+static bool database_Attach(uint size) {
+  if(size < DATABASE_INDEX_HEADER_SIZE) {
+    return false;
+  }
+  uint offset = 0;
+  for(uint index = 0; index < 16; index++) {
+    if(database_index[index] != DATABASE_INDEX_HEADER[index]) {
+      return false;
+    }
+  }
+  offset += 16;
+  if(state_ReadByte(database_index, offset) != DATABASE_INDEX_VERSION || state_ReadUint(database_index, offset) != database_size || state_ReadUint(database_index, offset) != database_modified) {
+    return false;
+  }
+  uint nameSize = state_ReadUint(database_index, offset);
+  database_count = state_ReadUint(database_index, offset);
+  database_titleSize = state_ReadUint(database_index, offset);
+  uint remaining = size - offset;
+  if(nameSize > remaining) {
+    return false;
+  }
+  remaining -= nameSize;
+  if(database_count > remaining / DATABASE_RECORD_SIZE) {
+    return false;
+  }
+  remaining -= database_count * DATABASE_RECORD_SIZE;
+  if(database_titleSize != remaining || (database_titleSize != 0 && database_index[size - 1] != 0)) {
+    return false;
+  }
+  if(database_filename.compare(0, std::string::npos, (const char*)database_index + offset, nameSize) != 0) {
+    return false;
+  }
+  database_records = database_index + offset + nameSize;
+  database_titles = database_records + (database_count * DATABASE_RECORD_SIZE);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Map
+// ----------------------------------------------------------------------------
+static bool database_Map( ) {
+  HANDLE file = CreateFile(database_GetIndexFilename( ).c_str( ), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  uint size = GetFileSize(file, NULL);
+  if(size == 0 || size == INVALID_FILE_SIZE) {
+    CloseHandle(file);
+    return false;
+  }
+  database_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if(database_mapping == NULL) {
+    return false;
+  }
+  database_index = (byte*)MapViewOfFile(database_mapping, FILE_MAP_READ, 0, 0, 0);
+  if(database_index == NULL || !database_Attach(size)) {
+    database_Release( );
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Compile
+// ----------------------------------------------------------------------------
+static bool database_Compile( ) {
+  FILE* file = fopen(database_filename.c_str( ), "r");
+  if(file == NULL) {
+    logger_LogError(IDS_DATABASE2,"");
+    return false;  
+  }
+
+  std::vector<databaseRecord> records;
+  char buffer[256];
+  while(fgets(buffer, 256, file) != NULL) {
+    databaseRecord record;
+    if(buffer[0] != '[' || !database_ParseDigest(buffer + 1, record.digest)) {
+      continue;
+    }
+    std::string entry[7];
+    for(int index = 0; index < 7; index++) {
+      if(fgets(buffer, 256, file) == NULL) {
+        buffer[0] = 0;
+      }
+      entry[index] = common_Remove(buffer, '\n');  
+    }
+    record.title = database_GetValue(entry[0]);
+    record.type = common_ParseByte(database_GetValue(entry[1]));
+    record.pokey = common_ParseBool(database_GetValue(entry[2]));
+    record.controller[0] = common_ParseByte(database_GetValue(entry[3]));
+    record.controller[1] = common_ParseByte(database_GetValue(entry[4]));
+    record.region = common_ParseByte(database_GetValue(entry[5]));
+    record.flags = common_ParseUint(database_GetValue(entry[6]));
+    records.push_back(record);
+  }
+  fclose(file);
+  std::stable_sort(records.begin( ), records.end( ), database_IsOrdered);
+
+  uint titleSize = 0;
+  uint index;
+  for(index = 0; index < records.size( ); index++) {
+    titleSize += records[index].title.size( ) + 1;
+  }
+  uint size = DATABASE_INDEX_HEADER_SIZE + database_filename.size( ) + (records.size( ) * DATABASE_RECORD_SIZE) + titleSize;
+  database_index = new byte[size];
+  if(database_index == NULL) {
+    return false;
+  }
+
+  uint offset = 0;
+  state_WriteBytes(database_index, offset, (const byte*)DATABASE_INDEX_HEADER, 16);
+  state_WriteByte(database_index, offset, DATABASE_INDEX_VERSION);
+  state_WriteUint(database_index, offset, database_size);
+  state_WriteUint(database_index, offset, database_modified);
+  state_WriteUint(database_index, offset, database_filename.size( ));
+  state_WriteUint(database_index, offset, records.size( ));
+  state_WriteUint(database_index, offset, titleSize);
+  state_WriteBytes(database_index, offset, (const byte*)database_filename.c_str( ), database_filename.size( ));
+  uint title = 0;
+  for(index = 0; index < records.size( ); index++) {
+    const databaseRecord& record = records[index];
+    state_WriteBytes(database_index, offset, record.digest, DATABASE_DIGEST_SIZE);
+    state_WriteByte(database_index, offset, record.type);
+    state_WriteByte(database_index, offset, record.pokey);
+    state_WriteByte(database_index, offset, record.controller[0]);
+    state_WriteByte(database_index, offset, record.controller[1]);
+    state_WriteByte(database_index, offset, record.region);
+    state_WriteUint(database_index, offset, record.flags);
+    state_WriteUint(database_index, offset, title);
+    title += record.title.size( ) + 1;
+  }
+  for(index = 0; index < records.size( ); index++) {
+    state_WriteBytes(database_index, offset, (const byte*)records[index].title.c_str( ), records[index].title.size( ) + 1);
+  }
+  database_Attach(size);
+
+  std::string filename = database_GetIndexFilename( );
+  file = fopen(filename.c_str( ), "wb");
+  if(file == NULL || fwrite(database_index, 1, size, file) != size) {
+    logger_LogError(IDS_DATABASE3, filename);
+  }
+  if(file != NULL) {
+    fclose(file);
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Open
+// ----------------------------------------------------------------------------
+bool database_Open( ) {
+  struct stat info = {0};
+  if(stat(database_filename.c_str( ), &info) != 0) {
+    logger_LogError(IDS_DATABASE2,"");
+    return false;
+  }
+  if(database_index != NULL && database_source == database_filename && database_size == (uint)info.st_size && database_modified == (uint)info.st_mtime) {
+    return true;
+  }
+
+  database_Release( );
+  database_size = info.st_size;
+  database_modified = info.st_mtime;
+  if(!database_Map( ) && !database_Compile( )) {
+    return false;
+  }
+  database_source = database_filename;
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 // Initialize
 // ----------------------------------------------------------------------------
@@ -39,43 +310,66 @@ void database_Initialize( ) {
   database_filename = common_defaultPath + "ProSystem.dat";
 }
 
+// ----------------------------------------------------------------------------
+// Find
+// ----------------------------------------------------------------------------
+bool database_Find(std::string digest, cartridgeInfo& info) {
+  byte key[DATABASE_DIGEST_SIZE];
+  if(database_index == NULL || !database_ParseDigest(digest, key)) {
+    return false;
+  }
+
+  uint low = 0;
+  uint high = database_count;
+  while(low < high) {
+    uint middle = (low + high) >> 1;
+    if(database_CompareDigest(database_records + (middle * DATABASE_RECORD_SIZE), key) < 0) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+  if(low >= database_count || database_CompareDigest(database_records + (low * DATABASE_RECORD_SIZE), key) != 0) {
+    return false;
+  }
+
+  uint offset = (low * DATABASE_RECORD_SIZE) + DATABASE_DIGEST_SIZE;
+  info.digest = digest;
+  info.type = state_ReadByte(database_records, offset);
+  info.pokey = state_ReadByte(database_records, offset) != 0;
+  info.controller[0] = state_ReadByte(database_records, offset);
+  info.controller[1] = state_ReadByte(database_records, offset);
+  info.region = state_ReadByte(database_records, offset);
+  info.flags = state_ReadUint(database_records, offset);
+  uint title = state_ReadUint(database_records, offset);
+  if(title < database_titleSize) {
+    info.title = (const char*)database_titles + title;
+  }
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 // Load
 // ----------------------------------------------------------------------------
 bool database_Load(std::string digest) {
   if(database_enabled) {
     logger_LogInfo(IDS_DATABASE1, database_filename);
-    
-    FILE* file = fopen(database_filename.c_str( ), "r");
-    if(file == NULL) {
-      logger_LogError(IDS_DATABASE2,"");
-      return false;  
+    if(!database_Open( )) {
+      return false;
     }
-
-    char buffer[256];
-    while(fgets(buffer, 256, file) != NULL) {
-      std::string line = buffer;
-      if(line.compare(1, 32, digest.c_str( )) == 0) {
-        std::string entry[7];
-        for(int index = 0; index < 7; index++) {
-          fgets(buffer, 256, file);
-          entry[index] = common_Remove(buffer, '\n');  
-        }
-        
-        cartridge_title = database_GetValue(entry[0]);
-        cartridge_type = common_ParseByte(database_GetValue(entry[1]));
-        cartridge_pokey = common_ParseBool(database_GetValue(entry[2]));
-        cartridge_controller[0] = common_ParseByte(database_GetValue(entry[3]));
-        cartridge_controller[1] = common_ParseByte(database_GetValue(entry[4]));
-        cartridge_region = common_ParseByte(database_GetValue(entry[5]));
-        cartridge_flags = common_ParseUint(database_GetValue(entry[6]));
-        break;
-      }
-    }    
     
-    fclose(file);  
+    cartridgeInfo info;
+    info.title = cartridge_title;
+    if(database_Find(digest, info)) {
+      cartridge_type = info.type;
+      cartridge_pokey = info.pokey;
+      cartridge_controller[0] = info.controller[0];
+      cartridge_controller[1] = info.controller[1];
+      cartridge_region = info.region;
+      cartridge_flags = info.flags;
+      cartridge_title = info.title;
+    }
   }
   return true;
 }
-
-
@@ -27,16 +27,25 @@
 
 #include <Windows.h>
 #include <String>
+#include <Vector>
+#include <Algorithm>
+#include <Ctype.h>
+#include <Sys/Types.h>
+#include <Sys/Stat.h>
 #include "Cartridge.h"
 #include "Logger.h"
 #include "Common.h"
+#include "State.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
 typedef unsigned int uint;
 
 extern void database_Initialize( );
+extern bool database_Open( );
 extern bool database_Load(std::string digest);
+extern bool database_Find(std::string digest, cartridgeInfo& info);
+extern void database_Release( );
 extern bool database_enabled;
 extern std::string database_filename;
 
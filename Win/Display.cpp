@@ -39,9 +39,6 @@ static LPDIRECTDRAWSURFACE display_offscreen = NULL;
 static LPDIRECTDRAWPALETTE display_palette = NULL;
 static LPDIRECTDRAWCLIPPER display_clipper = NULL;
 static HWND display_hWnd = NULL;
-static word display_palette16[256] = {0};
-static byte display_palette24[768] = {0};
-static uint display_palette32[256] = {0};
 
 // ----------------------------------------------------------------------------
 // ToMode
@@ -255,37 +252,30 @@ static bool display_ResetPalette16( ) {
   display_GetColorBits(mode16.bmask, &bshift, &bsize);
   display_GetColorBits(mode16.gmask, &gshift, &gsize);
      
+  word palette16[256];
   for(uint index = 0; index < 256; index++) {
     word r = ((palette_data[(index * 3) + 0] * (1 << rsize)) / 256) << rshift;
     word g = ((palette_data[(index * 3) + 1] * (1 << gsize)) / 256) << gshift;
     word b = ((palette_data[(index * 3) + 2] * (1 << bsize)) / 256) << bshift;
-    display_palette16[index] = r | g | b;
+    palette16[index] = r | g | b;
   }
+  blitter_SetPalette16(palette16);
    
   return true;
 }
 
-// ----------------------------------------------------------------------------
-// ResetPalette24
-// ----------------------------------------------------------------------------
-static void display_ResetPalette24( ) {
-  for(uint index = 0; index < 256; index++) {
-    display_palette24[(index * 3) + 0] = palette_data[(index * 3) + 2];
-    display_palette24[(index * 3) + 1] = palette_data[(index * 3) + 1];
-    display_palette24[(index * 3) + 2] = palette_data[(index * 3) + 0];
-  }
-}
-
 // ----------------------------------------------------------------------------
 // ResetPalette32
 // ----------------------------------------------------------------------------
 static void display_ResetPalette32( ) {
+  uint palette32[256];
   for(uint index = 0; index < 256; index++) {
     uint r = palette_data[(index * 3) + 0] << 16;
     uint g = palette_data[(index * 3) + 1] << 8;
     uint b = palette_data[(index * 3) + 2];
-    display_palette32[index] = r | g | b;
+    palette32[index] = r | g | b;
   }
+  blitter_SetPalette32(palette32);
 }
 
 // ----------------------------------------------------------------------------
@@ -546,58 +536,18 @@ bool display_Show( ) {
   
   const byte* buffer = maria_surface + ((maria_visibleArea.top - maria_displayArea.top) * maria_visibleArea.GetLength( ));
 
+  byte* surface = (byte*)offscreenDesc.lpSurface;
   if(offscreenDesc.ddpfPixelFormat.dwRGBBitCount == 8) {
-    byte* surface = (byte*)offscreenDesc.lpSurface;
-    for(uint indexY = 0; indexY < height; indexY++) {
-      for(uint indexX = 0; indexX < length; indexX += 4) {
-        surface[indexX + 0] = buffer[indexX + 0];
-        surface[indexX + 1] = buffer[indexX + 1];
-        surface[indexX + 2] = buffer[indexX + 2];
-        surface[indexX + 3] = buffer[indexX + 3];
-      }
-      surface += offscreenDesc.lPitch;
-      buffer += length;
-    }
+    blitter_Blit8(surface, offscreenDesc.lPitch, buffer, length, height);
   }
   else if(offscreenDesc.ddpfPixelFormat.dwRGBBitCount == 16) {
-    word* surface = (word*)offscreenDesc.lpSurface;
-    uint pitch = offscreenDesc.lPitch >> 1;
-    for(uint indexY = 0; indexY < height; indexY++) {
-      for(uint indexX = 0; indexX < length; indexX += 4) {
-        surface[indexX + 0] = display_palette16[buffer[indexX + 0]];
-        surface[indexX + 1] = display_palette16[buffer[indexX + 1]];
-        surface[indexX + 2] = display_palette16[buffer[indexX + 2]];
-        surface[indexX + 3] = display_palette16[buffer[indexX + 3]];
-      }
-      surface += pitch;
-      buffer += length;
-    }
+    blitter_Blit16(surface, offscreenDesc.lPitch, buffer, length, height);
   }
   else if(offscreenDesc.ddpfPixelFormat.dwRGBBitCount == 24) {
-    byte* surface = (byte*)offscreenDesc.lpSurface;
-    for(uint indexY = 0; indexY < height; indexY++) {
-      for(uint indexX = 0; indexX < length; indexX++) {
-        surface[(indexX * 3) + 0] = display_palette24[(buffer[indexX] * 3) + 0];
-        surface[(indexX * 3) + 1] = display_palette24[(buffer[indexX] * 3) + 1];
-        surface[(indexX * 3) + 2] = display_palette24[(buffer[indexX] * 3) + 2];
-      }
-      surface += offscreenDesc.lPitch;
-      buffer += length;
-    }    
+    blitter_Blit24(surface, offscreenDesc.lPitch, buffer, length, height);
   }
   else if(offscreenDesc.ddpfPixelFormat.dwRGBBitCount == 32) {
-    uint* surface = (uint*)offscreenDesc.lpSurface;
-    uint pitch = offscreenDesc.lPitch >> 2;
-    for(uint indexY = 0; indexY < height; indexY++) {
-      for(uint indexX = 0; indexX < length; indexX += 4) {
-        surface[indexX + 0] = display_palette32[buffer[indexX + 0]];
-        surface[indexX + 1] = display_palette32[buffer[indexX + 1]];
-        surface[indexX + 2] = display_palette32[buffer[indexX + 2]];
-        surface[indexX + 3] = display_palette32[buffer[indexX + 3]];
-      }
-      surface += pitch;
-      buffer += length;
-    }
+    blitter_Blit32(surface, offscreenDesc.lPitch, buffer, length, height);
   }
 
   hr = display_offscreen->Unlock(NULL);
@@ -628,7 +578,6 @@ bool display_Show( ) {
 // ResetPalette
 // ----------------------------------------------------------------------------
 bool display_ResetPalette( ) {
-  display_ResetPalette24( );
   display_ResetPalette32( );
   if(!display_ResetPalette16( )) {
     logger_LogError(IDS_DISPLAY28,"");
@@ -645,47 +594,11 @@ bool display_ResetPalette( ) {
 // TakeScreenshot
 // ----------------------------------------------------------------------------
 bool display_TakeScreenshot(std::string filename) {
-  if(filename.empty( ) || filename.length == 0) {
+  if(filename.empty( ) || filename.length( ) == 0) {
     logger_LogError(IDS_DISPLAY30,"");
     return false;
   }
-
-  BITMAPFILEHEADER bitmapFileHeader = {0};
-  bitmapFileHeader.bfType = 0x4d42;
-  bitmapFileHeader.bfSize = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + (maria_visibleArea.GetArea( ) * 3);
-  bitmapFileHeader.bfReserved1 = 0;
-  bitmapFileHeader.bfReserved2 = 0;
-  bitmapFileHeader.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
-
-  BITMAPINFOHEADER bitmapInfoHeader = {0};
-  bitmapInfoHeader.biSize = sizeof(BITMAPINFOHEADER);
-  bitmapInfoHeader.biWidth = maria_visibleArea.GetLength( );
-  bitmapInfoHeader.biHeight = maria_visibleArea.GetHeight( );
-  bitmapInfoHeader.biPlanes = 1;
-  bitmapInfoHeader.biBitCount = 24;
-  
-  FILE* file = fopen(filename.c_str( ), "wb");
-  if(file == NULL) {
-    logger_LogError(IDS_DISPLAY31, filename);
-    return false;
-  }
-
-  fwrite(&bitmapFileHeader, sizeof(BITMAPFILEHEADER), 1, file);
-  fwrite(&bitmapInfoHeader, sizeof(BITMAPINFOHEADER), 1, file);
-
-  const byte* buffer = maria_surface + (maria_visibleArea.top - maria_displayArea.top) * maria_visibleArea.GetLength( );
-
-  for(int row = maria_visibleArea.GetHeight( ) - 1; row >= 0; row--) {
-    for(uint column = 0; column < maria_visibleArea.GetLength( ); column++) {
-      byte entry = buffer[(row * maria_visibleArea.GetLength( )) + column];
-      fwrite(&palette_data[(entry * 3) + 2], 1, 1, file);
-      fwrite(&palette_data[(entry * 3) + 1], 1, 1, file);
-      fwrite(&palette_data[(entry * 3) + 0], 1, 1, file);
-    }
-  }  
-  
-  fclose(file);
-  return true;
+  return image_Save(filename);
 }
 
 // ----------------------------------------------------------------------------
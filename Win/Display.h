@@ -31,6 +31,8 @@
 #include <Vector>
 #include "Palette.h"
 #include "Maria.h"
+#include "Image.h"
+#include "Blitter.h"
 #include "Common.h"
 #include "Logger.h"
 
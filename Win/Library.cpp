@@ -0,0 +1,442 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Library.cpp
+// ----------------------------------------------------------------------------
+#include "Library.h"
+#define LIBRARY_EXTENSIONS ".a78;.bin"
+#define LIBRARY_ARCHIVE_EXTENSIONS ".zip"
+#define LIBRARY_SIZE_MAX 1048576
+#define LIBRARY_CACHE_HEADER "PRO-SYSTEM CACHE"
+#define LIBRARY_CACHE_VERSION 2
+
+uint library_hits = 0;
+uint library_misses = 0;
+
+static std::vector<libraryEntry> library_entries;
+static std::vector<uint> library_jobs;
+static long library_next = 0;
+static CRITICAL_SECTION library_lock;
+
+// ----------------------------------------------------------------------------
+// GetCacheFilename
+// ----------------------------------------------------------------------------
+static std::string library_GetCacheFilename( ) {
+  return common_defaultPath + "ProSystem.lib";
+}
+
+// ----------------------------------------------------------------------------
+// IsOrdered
+// ----------------------------------------------------------------------------
+static bool library_IsOrdered(const libraryEntry& entry1, const libraryEntry& entry2) {
+  return entry1.filename < entry2.filename;
+}
+
+// ----------------------------------------------------------------------------
+// HasExtension
+// ----------------------------------------------------------------------------
+static bool library_HasExtension(std::string filename, std::string extensions) {
+  std::string extension = common_GetExtension(filename);
+  if(extension.empty( )) {
+    return false;
+  }
+  for(uint index = 0; index < extension.size( ); index++) {
+    extension[index] = tolower(extension[index]);
+  }
+  return (extensions + ";").find(extension + ";") != std::string::npos;
+}
+
+// ----------------------------------------------------------------------------
+// Walk
+// ----------------------------------------------------------------------------
+static bool library_Walk(std::string path, std::vector<libraryEntry>& entries) {
+  WIN32_FIND_DATA data;
+  HANDLE find = FindFirstFile((path + "\\*").c_str( ), &data);
+  if(find == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  do {
+    std::string name = data.cFileName;
+    if(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      if(name != "." && name != "..") {
+        library_Walk(path + "\\" + name, entries);
+      }
+    }
+    else if(library_HasExtension(name, LIBRARY_EXTENSIONS ";" LIBRARY_ARCHIVE_EXTENSIONS)) {
+      libraryEntry entry;
+      entry.filename = path + "\\" + name;
+      entry.size = data.nFileSizeLow;
+      entry.modified[0] = data.ftLastWriteTime.dwLowDateTime;
+      entry.modified[1] = data.ftLastWriteTime.dwHighDateTime;
+      entry.valid = false;
+      entry.known = false;
+      entries.push_back(entry);
+    }
+  } while(FindNextFile(find, &data));
+  FindClose(find);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Extract
+// ----------------------------------------------------------------------------
+static byte* library_Extract(std::string filename, uint& size) {
+  byte* data = NULL;
+  EnterCriticalSection(&library_lock);
+  archive* handle = archive_Open(filename);
+  if(handle != NULL) {
+    uint index = archive_Find(handle, LIBRARY_EXTENSIONS);
+    if(index == ARCHIVE_NONE && archive_GetCount(handle) == 1) {
+      index = 0;
+    }
+    if(index != ARCHIVE_NONE) {
+      size = archive_GetSize(handle, index);
+      if(size <= LIBRARY_SIZE_MAX) {
+        data = new byte[size];
+        if(data != NULL && archive_Read(handle, index, data, size) != size) {
+          delete [ ] data;
+          data = NULL;
+        }
+      }
+    }
+    archive_Close(handle);
+  }
+  LeaveCriticalSection(&library_lock);
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// Identify
+// ----------------------------------------------------------------------------
+static void library_Identify(libraryEntry& entry) {
+  byte* data = NULL;
+  uint size = 0;
+  if(library_HasExtension(entry.filename, LIBRARY_ARCHIVE_EXTENSIONS)) {
+    data = library_Extract(entry.filename, size);
+  }
+  else if(entry.size <= LIBRARY_SIZE_MAX) {
+    FILE* file = fopen(entry.filename.c_str( ), "rb");
+    if(file != NULL) {
+      size = entry.size;
+      data = new byte[size];
+      if(data != NULL && fread(data, 1, size, file) != size) {
+        delete [ ] data;
+        data = NULL;
+      }
+      fclose(file);
+    }
+  }
+  entry.valid = cartridge_Identify(data, size, entry.header);
+  delete [ ] data;
+}
+
+// ----------------------------------------------------------------------------
+// Run
+// ----------------------------------------------------------------------------
+static void library_Run( ) {
+  uint index;
+  while((index = (uint)InterlockedIncrement(&library_next) - 1) < library_jobs.size( )) {
+    library_Identify(library_entries[library_jobs[index]]);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// GetThreadCount
+// ----------------------------------------------------------------------------
+static uint library_GetThreadCount( ) {
+  SYSTEM_INFO system;
+  GetSystemInfo(&system);
+  uint count = system.dwNumberOfProcessors;
+  if(count > LIBRARY_THREADS_MAX) {
+    count = LIBRARY_THREADS_MAX;
+  }
+  if(count > library_jobs.size( )) {
+    count = library_jobs.size( );
+  }
+  return (count == 0)? 1: count;
+}
+
+// ----------------------------------------------------------------------------
+// Dispatch
+// ----------------------------------------------------------------------------
+static void library_Dispatch( ) {
+  thread* threads[LIBRARY_THREADS_MAX];
+  uint count = library_GetThreadCount( );
+  uint index;
+
+  library_next = 0;
+  InitializeCriticalSection(&library_lock);
+  for(index = 1; index < count; index++) {
+    threads[index] = thread_Create(library_Run);
+  }
+  library_Run( );
+  for(index = 1; index < count; index++) {
+    if(threads[index] != NULL) {
+      thread_Join(threads[index]);
+    }
+  }
+  DeleteCriticalSection(&library_lock);
+}
+
+// ----------------------------------------------------------------------------
+// GetInfoSize
+// ----------------------------------------------------------------------------
+static uint library_GetInfoSize(const cartridgeInfo& info) {
+  return 4 + info.digest.size( ) + 4 + info.title.size( ) + 4 + 5 + 4;
+}
+
+// ----------------------------------------------------------------------------
+// WriteString
+// ----------------------------------------------------------------------------
+static void library_WriteString(byte* buffer, uint& offset, const std::string& text) {
+  state_WriteUint(buffer, offset, text.size( ));
+  state_WriteBytes(buffer, offset, (const byte*)text.c_str( ), text.size( ));
+}
+
+// ----------------------------------------------------------------------------
+// ReadString
+// ----------------------------------------------------------------------------
+static bool library_ReadString(const byte* buffer, uint& offset, uint size, std::string& text) {
+  if(offset + 4 > size) {
+    return false;
+  }
+  uint length = state_ReadUint(buffer, offset);
+  if(length > size - offset) {
+    return false;
+  }
+  text.assign((const char*)buffer + offset, length);
+  offset += length;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// ReadInfo
+// ----------------------------------------------------------------------------
+static bool library_ReadInfo(const byte* buffer, uint& offset, uint size, cartridgeInfo& info) {
+  if(!library_ReadString(buffer, offset, size, info.digest) || !library_ReadString(buffer, offset, size, info.title) || offset + 13 > size) {
+    return false;
+  }
+  info.size = state_ReadUint(buffer, offset);
+  info.type = state_ReadByte(buffer, offset);
+  info.pokey = state_ReadByte(buffer, offset) != 0;
+  info.controller[0] = state_ReadByte(buffer, offset);
+  info.controller[1] = state_ReadByte(buffer, offset);
+  info.region = state_ReadByte(buffer, offset);
+  info.flags = state_ReadUint(buffer, offset);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// LoadCache
+// ----------------------------------------------------------------------------
+static void library_LoadCache(std::vector<libraryEntry>& entries) {
+  FILE* file = fopen(library_GetCacheFilename( ).c_str( ), "rb");
+  if(file == NULL) {
+    return;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  if(size < 21) {
+    fclose(file);
+    return;
+  }
+  byte* buffer = new byte[size];
+  if(buffer == NULL || fread(buffer, 1, size, file) != (size_t)size) {
+    delete [ ] buffer;
+    fclose(file);
+    return;
+  }
+  fclose(file);
+
+  uint offset = 0;
+  for(offset = 0; offset < 16; offset++) {
+    if(buffer[offset] != LIBRARY_CACHE_HEADER[offset]) {
+      delete [ ] buffer;
+      return;
+    }
+  }
+  if(state_ReadByte(buffer, offset) != LIBRARY_CACHE_VERSION) {
+    delete [ ] buffer;
+    return;
+  }
+  uint count = state_ReadUint(buffer, offset);
+  for(uint index = 0; index < count; index++) {
+    libraryEntry entry;
+    if(!library_ReadString(buffer, offset, size, entry.filename) || offset + 13 > (uint)size) {
+      break;
+    }
+    entry.size = state_ReadUint(buffer, offset);
+    entry.modified[0] = state_ReadUint(buffer, offset);
+    entry.modified[1] = state_ReadUint(buffer, offset);
+    entry.valid = state_ReadByte(buffer, offset) != 0;
+    entry.known = false;
+    if(entry.valid && !library_ReadInfo(buffer, offset, size, entry.header)) {
+      break;
+    }
+    entries.push_back(entry);
+  }
+  delete [ ] buffer;
+  std::stable_sort(entries.begin( ), entries.end( ), library_IsOrdered);
+}
+
+// ----------------------------------------------------------------------------
+// SaveCache
+// ----------------------------------------------------------------------------
+static bool library_SaveCache( ) {
+  uint size = 21;
+  uint index;
+  for(index = 0; index < library_entries.size( ); index++) {
+    const libraryEntry& entry = library_entries[index];
+    size += 4 + entry.filename.size( ) + 13;
+    if(entry.valid) {
+      size += library_GetInfoSize(entry.header);
+    }
+  }
+  byte* buffer = new byte[size];
+  if(buffer == NULL) {
+    return false;
+  }
+
+  uint offset = 0;
+  state_WriteBytes(buffer, offset, (const byte*)LIBRARY_CACHE_HEADER, 16);
+  state_WriteByte(buffer, offset, LIBRARY_CACHE_VERSION);
+  state_WriteUint(buffer, offset, library_entries.size( ));
+  for(index = 0; index < library_entries.size( ); index++) {
+    const libraryEntry& entry = library_entries[index];
+    library_WriteString(buffer, offset, entry.filename);
+    state_WriteUint(buffer, offset, entry.size);
+    state_WriteUint(buffer, offset, entry.modified[0]);
+    state_WriteUint(buffer, offset, entry.modified[1]);
+    state_WriteByte(buffer, offset, entry.valid);
+    if(entry.valid) {
+      library_WriteString(buffer, offset, entry.header.digest);
+      library_WriteString(buffer, offset, entry.header.title);
+      state_WriteUint(buffer, offset, entry.header.size);
+      state_WriteByte(buffer, offset, entry.header.type);
+      state_WriteByte(buffer, offset, entry.header.pokey);
+      state_WriteByte(buffer, offset, entry.header.controller[0]);
+      state_WriteByte(buffer, offset, entry.header.controller[1]);
+      state_WriteByte(buffer, offset, entry.header.region);
+      state_WriteUint(buffer, offset, entry.header.flags);
+    }
+  }
+
+  std::string filename = library_GetCacheFilename( );
+  FILE* file = fopen(filename.c_str( ), "wb");
+  bool result = file != NULL && fwrite(buffer, 1, size, file) == size;
+  if(file != NULL) {
+    fclose(file);
+  }
+  delete [ ] buffer;
+  if(!result) {
+    logger_LogError(IDS_LIBRARY2, filename);
+  }
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// Join
+// ----------------------------------------------------------------------------
+static void library_Join( ) {
+  bool joined = database_enabled && database_Open( );
+  for(uint index = 0; index < library_entries.size( ); index++) {
+    libraryEntry& entry = library_entries[index];
+    entry.info = entry.header;
+    entry.known = joined && entry.valid && database_Find(entry.header.digest, entry.info);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Scan
+// ----------------------------------------------------------------------------
+bool library_Scan(std::string path) {
+  if(!path.empty( ) && path[path.size( ) - 1] == '\\') {
+    path.erase(path.size( ) - 1);
+  }
+  std::vector<libraryEntry> entries;
+  if(!library_Walk(path, entries)) {
+    logger_LogError(IDS_LIBRARY1, path);
+    return false;
+  }
+  std::stable_sort(entries.begin( ), entries.end( ), library_IsOrdered);
+
+  std::vector<libraryEntry> cache;
+  if(library_entries.empty( )) {
+    library_LoadCache(cache);
+  }
+  else {
+    cache.swap(library_entries);
+  }
+
+  library_hits = 0;
+  library_misses = 0;
+  library_jobs.clear( );
+  uint index;
+  for(index = 0; index < entries.size( ); index++) {
+    libraryEntry& entry = entries[index];
+    std::vector<libraryEntry>::iterator cached = std::lower_bound(cache.begin( ), cache.end( ), entry, library_IsOrdered);
+    if(cached != cache.end( ) && cached->filename == entry.filename && cached->size == entry.size && cached->modified[0] == entry.modified[0] && cached->modified[1] == entry.modified[1]) {
+      entry.valid = cached->valid;
+      entry.header = cached->header;
+      library_hits++;
+    }
+    else {
+      library_jobs.push_back(index);
+      library_misses++;
+    }
+  }
+
+  library_entries.swap(entries);
+  if(!library_jobs.empty( )) {
+    library_Dispatch( );
+  }
+  if(library_misses != 0 || library_hits != cache.size( )) {
+    library_SaveCache( );
+  }
+  library_jobs.clear( );
+  library_Join( );
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// GetCount
+// ----------------------------------------------------------------------------
+uint library_GetCount( ) {
+  return library_entries.size( );
+}
+
+// ----------------------------------------------------------------------------
+// GetEntry
+// ----------------------------------------------------------------------------
+const libraryEntry& library_GetEntry(uint index) {
+  return library_entries[index];
+}
+
+// ----------------------------------------------------------------------------
+// Release
+// ----------------------------------------------------------------------------
+void library_Release( ) {
+  library_entries.clear( );
+  library_jobs.clear( );
+}
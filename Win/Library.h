@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------------------
+//   ___  ___  ___  ___       ___  ____  ___  _  _
+//  /__/ /__/ /  / /__  /__/ /__    /   /_   / |/ /
+// /    / \  /__/ ___/ ___/ ___/   /   /__  /    /  emulator
+//
+// ----------------------------------------------------------------------------
+// Copyright 2005 Greg Stanton
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+// Library.h
+// ----------------------------------------------------------------------------
+#ifndef LIBRARY_H
+#define LIBRARY_H
+#define LIBRARY_THREADS_MAX 8
+#define NULL 0
+
+#include <Windows.h>
+#include <String>
+#include <Vector>
+#include <Algorithm>
+#include "Cartridge.h"
+#include "Archive.h"
+#include "Hash.h"
+#include "Logger.h"
+#include "Common.h"
+#include "Database.h"
+#include "State.h"
+#include "Thread.h"
+
+typedef unsigned char byte;
+typedef unsigned short word;
+typedef unsigned int uint;
+
+struct LibraryEntry {
+  std::string filename;
+  uint size;
+  uint modified[2];
+  bool valid;
+  bool known;
+  cartridgeInfo header;
+  cartridgeInfo info;
+};
+
+typedef LibraryEntry libraryEntry;
+
+extern bool library_Scan(std::string path);
+extern uint library_GetCount( );
+extern const libraryEntry& library_GetEntry(uint index);
+extern void library_Release( );
+extern uint library_hits;
+extern uint library_misses;
+
+#endif
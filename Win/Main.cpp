@@ -53,10 +53,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR commandLi
   logger_Initialize(common_defaultPath + "ProSystem.log");
   logger_level = LOGGER_LEVEL_DEBUG;
 
-  console_Initialize(hInstance, commandLine);
-
-  console_Run( );
+  if(console_Initialize(hInstance, commandLine)) {
+    console_Run( );
+  }
   
   logger_Release( );
-  return 1;
+  return (batch_IsEnabled( ))? batch_result: 1;
 }
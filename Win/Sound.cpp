@@ -24,48 +24,22 @@
 // ----------------------------------------------------------------------------
 #include "Sound.h"
 #define SOUND_LATENCY_SCALE 4
+#define SOUND_PULL_SIZE 2048
 
 byte sound_latency = SOUND_LATENCY_VERY_LOW;
 
-static const WAVEFORMATEX SOUND_DEFAULT_FORMAT = {WAVE_FORMAT_PCM, 1, 44100, 44100, 1, 8, 0};
+static const WAVEFORMATEX SOUND_DEFAULT_FORMAT = {WAVE_FORMAT_PCM, 1, 44100, 88200, 2, 16, 0};
 static LPDIRECTSOUND sound_dsound = NULL;
 static LPDIRECTSOUNDBUFFER sound_primaryBuffer = NULL;
 static LPDIRECTSOUNDBUFFER sound_buffer = NULL;
 static WAVEFORMATEX sound_format = SOUND_DEFAULT_FORMAT;
 static uint sound_counter = 0;
 static bool sound_muted = false;
-
-// ----------------------------------------------------------------------------
-// GetSampleLength
-// ----------------------------------------------------------------------------
-static uint sound_GetSampleLength(uint length, uint unit, uint unitMax) {
-  uint sampleLength = length / unitMax;
-  uint sampleRemain = length % unitMax;
-  if(sampleRemain != 0 && sampleRemain >= unit) {
-    sampleLength++;
-  }
-  return sampleLength;
-}
-
-// ----------------------------------------------------------------------------
-// Resample
-// ----------------------------------------------------------------------------
-static void sound_Resample(const byte* source, byte* target, int length) {
-  int measurement = sound_format.nSamplesPerSec;
-  int sourceIndex = 0;
-  int targetIndex = 0;
-  
-  while(targetIndex < length) {
-    if(measurement >= 31440) {
-      target[targetIndex++] = source[sourceIndex];
-      measurement -= 31440;
-    }
-    else {
-      sourceIndex++;
-      measurement += sound_format.nSamplesPerSec;
-    }
-  }
-}
+static thread* sound_thread = NULL;
+static threadEvent* sound_event = NULL;
+static volatile bool sound_pulling = false;
+static volatile int sound_error = 0;
+static volatile HRESULT sound_result = 0;
 
 // ----------------------------------------------------------------------------
 // RestoreBuffer
@@ -114,6 +88,139 @@ static bool sound_ReleaseSound( ) {
   return true;
 }
 
+// ----------------------------------------------------------------------------
+// Fail
+// ----------------------------------------------------------------------------
+static void sound_Fail(int error, HRESULT result) {
+  sound_result = result;
+  thread_Barrier( );
+  sound_error = error;
+}
+
+// ----------------------------------------------------------------------------
+// Recover
+// ----------------------------------------------------------------------------
+static bool sound_Recover( ) {
+  int error = sound_error;
+  if(error == 0) {
+    return true;
+  }
+  thread_Barrier( );
+  HRESULT result = sound_result;
+  logger_LogError(error,"");
+  logger_LogError("",common_Format(result));
+  if(result != DSERR_BUFFERLOST || !sound_RestoreBuffer( )) {
+    return false;
+  }
+  thread_Barrier( );
+  sound_error = 0;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Write
+// ----------------------------------------------------------------------------
+static bool sound_Write(const short* samples, uint length) {
+  DWORD lockCount = 0;
+  byte* lockStream = NULL;
+  DWORD wrapCount = 0;
+  byte* wrapStream = NULL;
+  
+  HRESULT hr = sound_buffer->Lock(sound_counter, length, (void**)&lockStream, &lockCount, (void**)&wrapStream, &wrapCount, 0);
+  if(FAILED(hr) || lockStream == NULL) {
+    sound_Fail(IDS_SOUND12, hr);
+    return false;
+  }
+
+  const byte* source = (const byte*)samples;
+  uint bufferCounter = 0;
+  for(uint lockIndex = 0; lockIndex < lockCount; lockIndex++) {
+    lockStream[lockIndex] = source[bufferCounter++];
+  }
+  
+  for(uint wrapIndex = 0; wrapIndex < wrapCount; wrapIndex++) {
+    wrapStream[wrapIndex] = source[bufferCounter++];
+  }
+  
+  hr = sound_buffer->Unlock(lockStream, lockCount, wrapStream, wrapCount);
+  if(FAILED(hr)) {
+    sound_Fail(IDS_SOUND13, hr);
+    return false;
+  }
+ 
+  sound_counter += length;
+  if(sound_counter >= sound_format.nAvgBytesPerSec) {
+    sound_counter -= sound_format.nAvgBytesPerSec;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// GetLead
+// ----------------------------------------------------------------------------
+static uint sound_GetLead( ) {
+  return (sound_format.nSamplesPerSec / prosystem_frequency) * (sound_latency * SOUND_LATENCY_SCALE + 1) * sound_format.nBlockAlign;
+}
+
+// ----------------------------------------------------------------------------
+// Fill
+// ----------------------------------------------------------------------------
+static void sound_Fill( ) {
+  DWORD play = 0;
+  DWORD write = 0;
+  if(FAILED(sound_buffer->GetCurrentPosition(&play, &write))) {
+    return;
+  }
+
+  uint size = sound_format.nAvgBytesPerSec;
+  uint lead = sound_GetLead( );
+  uint ahead = (sound_counter + size - play) % size;
+  if(ahead > size / 2) {
+    sound_counter = write;
+    ahead = (write + size - play) % size;
+  }
+
+  short samples[SOUND_PULL_SIZE];
+  uint length = (ahead < lead)? (lead - ahead) & ~1: 0;
+  while(length != 0) {
+    uint count = (length < sizeof(samples))? length: sizeof(samples);
+    audio_Read(samples, count >> 1);
+    if(!sound_Write(samples, count)) {
+      return;
+    }
+    length -= count;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Pull
+// ----------------------------------------------------------------------------
+static void sound_Pull( ) {
+  while(true) {
+    thread_Wait(sound_event);
+    if(!sound_pulling) {
+      break;
+    }
+    if(sound_error == 0) {
+      sound_Fill( );
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// StopThread
+// ----------------------------------------------------------------------------
+static void sound_StopThread( ) {
+  if(sound_thread != NULL) {
+    sound_pulling = false;
+    thread_Signal(sound_event);
+    thread_Join(sound_thread);
+    sound_thread = NULL;
+    thread_ReleaseEvent(sound_event);
+    sound_event = NULL;
+  }
+}
+
 // ----------------------------------------------------------------------------
 // Initialize
 // ----------------------------------------------------------------------------
@@ -174,6 +281,7 @@ bool sound_SetFormat(WAVEFORMATEX format) {
     return false;
   }
   
+  sound_StopThread( );
   HRESULT hr = sound_primaryBuffer->SetFormat(&format);
   if(FAILED(hr)) {
     logger_LogError(IDS_SOUND9,"");
@@ -185,7 +293,7 @@ bool sound_SetFormat(WAVEFORMATEX format) {
   secondaryDesc.dwReserved = 0;
   secondaryDesc.dwSize = sizeof(DSBUFFERDESC);
   secondaryDesc.dwFlags = DSBCAPS_GLOBALFOCUS;
-  secondaryDesc.dwBufferBytes = format.nSamplesPerSec;
+  secondaryDesc.dwBufferBytes = format.nAvgBytesPerSec;
   secondaryDesc.lpwfxFormat = &format;
   
   hr = sound_dsound->CreateSoundBuffer(&secondaryDesc, &sound_buffer, NULL);
@@ -196,6 +304,7 @@ bool sound_SetFormat(WAVEFORMATEX format) {
   }    
 
   sound_format = format;
+  audio_SetSampleRate(format.nSamplesPerSec);
   return true;
 }
 
@@ -216,56 +325,13 @@ bool sound_Store( ) {
     return false;
   }
     
-  byte sample[1920];
-  uint length = sound_GetSampleLength(sound_format.nSamplesPerSec, prosystem_frame, prosystem_frequency);
-  sound_Resample(tia_buffer, sample, length);
-  
-  if(cartridge_pokey) {
-    byte pokeySample[1920];
-    sound_Resample(pokey_buffer, pokeySample, length);
-    for(int index = 0; index < length; index++) {
-      sample[index] += pokeySample[index];
-      sample[index] = sample[index] / 2;
-    }
-  }
-  
-  DWORD lockCount = 0;
-  byte* lockStream = NULL;
-  DWORD wrapCount = 0;
-  byte* wrapStream = NULL;
-  
-  HRESULT hr = sound_buffer->Lock(sound_counter, length, (void**)&lockStream, &lockCount, (void**)&wrapStream, &wrapCount, 0);
-  if(FAILED(hr) || lockStream == NULL) {
-    logger_LogError(IDS_SOUND12,"");
-    logger_LogError("",common_Format(hr));
-    if(hr != DSERR_BUFFERLOST || !sound_RestoreBuffer( )) {
+  if(sound_thread != NULL) {
+    if(!sound_Recover( )) {
       return false;
     }
+    audio_Store( );
+    thread_Signal(sound_event);
   }
-
-  uint bufferCounter = 0;
-  for(uint lockIndex = 0; lockIndex < lockCount; lockIndex++) {
-    lockStream[lockIndex] = sample[bufferCounter++];
-  }
-  
-  for(uint wrapIndex = 0; wrapIndex < wrapCount; wrapIndex++) {
-    wrapStream[wrapIndex] = sample[bufferCounter++];
-  }
-  
-  hr = sound_buffer->Unlock(lockStream, lockCount, wrapStream, wrapCount);
-  if(FAILED(hr)) {
-    logger_LogError(IDS_SOUND13,"");
-    logger_LogError("",common_Format(hr));
-    if(hr != DSERR_BUFFERLOST || !sound_RestoreBuffer( )) {
-      return false;
-    }
-  }  
- 
-  sound_counter += length;
-  if(sound_counter >= sound_format.nSamplesPerSec) {
-    sound_counter -= sound_format.nSamplesPerSec;
-  }
-    
   return true;
 }
 
@@ -288,7 +354,7 @@ bool sound_Clear( ) {
 
   byte* lockStream = NULL;  
   DWORD lockCount = 0;
-  HRESULT hr = sound_buffer->Lock(0, sound_format.nSamplesPerSec, (void**)&lockStream, &lockCount, NULL, NULL, DSBLOCK_ENTIREBUFFER);
+  HRESULT hr = sound_buffer->Lock(0, sound_format.nAvgBytesPerSec, (void**)&lockStream, &lockCount, NULL, NULL, DSBLOCK_ENTIREBUFFER);
   if(FAILED(hr) || lockStream == NULL) {
     logger_LogError(IDS_SOUND12,"");
     logger_LogError("",common_Format(hr));
@@ -331,6 +397,7 @@ bool sound_Play( ) {
   }
 
   if(!sound_muted) {
+    sound_StopThread( );
     HRESULT hr = sound_buffer->SetCurrentPosition(0);
     if(FAILED(hr)) {
       logger_LogError(IDS_SOUND14,"");
@@ -346,7 +413,24 @@ bool sound_Play( ) {
         return false;
       }    
     }
-    sound_counter = (sound_format.nSamplesPerSec / prosystem_frequency) * (sound_latency * SOUND_LATENCY_SCALE);
+    sound_counter = 0;
+    audio_Reset( );
+    audio_SetLatency((sound_format.nSamplesPerSec / prosystem_frequency) << 1);
+    sound_error = 0;
+    sound_event = thread_CreateEvent( );
+    if(sound_event == NULL) {
+      logger_LogError(IDS_SOUND17,"");
+      return false;
+    }
+    sound_pulling = true;
+    sound_thread = thread_Create(sound_Pull);
+    if(sound_thread == NULL) {
+      sound_pulling = false;
+      thread_ReleaseEvent(sound_event);
+      sound_event = NULL;
+      logger_LogError(IDS_SOUND17,"");
+      return false;
+    }
   }
   return true;
 }
@@ -368,6 +452,7 @@ bool sound_Stop( ) {
     return false;
   }
   
+  sound_StopThread( );
   HRESULT hr = sound_buffer->Stop( );
   if(FAILED(hr)) {
     logger_LogError(IDS_SOUND16,"");
@@ -385,7 +470,7 @@ bool sound_Stop( ) {
 // ----------------------------------------------------------------------------
 bool sound_SetSampleRate(uint rate) {
   sound_format.nSamplesPerSec = rate;
-  sound_format.nAvgBytesPerSec = rate;
+  sound_format.nAvgBytesPerSec = rate * sound_format.nBlockAlign;
   return sound_SetFormat(sound_format);
 }
 
@@ -427,6 +512,7 @@ bool sound_IsMuted( ) {
 // Release
 // ----------------------------------------------------------------------------
 void sound_Release( ) {
+  sound_StopThread( );
   sound_ReleaseBuffer(sound_buffer);
   sound_ReleaseBuffer(sound_primaryBuffer);
   sound_ReleaseSound( );
@@ -39,6 +39,8 @@
 #include "Configuration.h"
 #include "Tia.h"
 #include "Pokey.h"
+#include "Audio.h"
+#include "Thread.h"
 
 typedef unsigned char byte;
 typedef unsigned short word;
@@ -44,6 +44,7 @@
 #define IDS_PROSYSTEM13                 42
 #define IDS_PROSYSTEM14                 43
 #define IDS_PROSYSTEM15                 44
+#define IDS_PROSYSTEM16                 158
 #define IDS_CONSOLE1                    45
 #define IDS_CONSOLE2                    46
 #define IDS_CONSOLE3                    47
@@ -141,6 +142,30 @@
 #define IDS_STRING132                   132
 #define IDS_CARTRIDGE8                  133
 #define IDS_CARTRIDGE9                  134
+#define IDS_AUDIO1                      135
+#define IDS_AUDIO2                      136
+#define IDS_SOUND17                     137
+#define IDS_REWIND1                     138
+#define IDS_MOVIE1                      139
+#define IDS_MOVIE2                      140
+#define IDS_MOVIE3                      141
+#define IDS_MOVIE4                      142
+#define IDS_MOVIE5                      143
+#define IDS_MOVIE6                      144
+#define IDS_BOOT1                       145
+#define IDS_MACHINE1                    146
+#define IDS_CHECKSUM1                   147
+#define IDS_CHECKSUM2                   148
+#define IDS_WRITER1                     149
+#define IDS_WRITER2                     150
+#define IDS_DATABASE3                   151
+#define IDS_LIBRARY1                    152
+#define IDS_LIBRARY2                    153
+#define IDS_LIBRARY3                    159
+#define IDS_IMAGE1                      154
+#define IDS_IMAGE2                      155
+#define IDS_CAPTURE1                    156
+#define IDS_CAPTURE2                    157
 #define IDC_BUTTON_ABOUT_OK             1170
 #define IDC_BUTTON_CONTROLLER_OK        1175
 #define IDC_COMBO_CONTROLLER_UP         1176